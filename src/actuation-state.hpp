@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ACTUATION_STATE_HPP
+#define ACTUATION_STATE_HPP
+
+#include <cstdint>
+
+/**
+ * Actuation as requested by the input; it is handed from the input thread
+ * to the sender through a TripleBuffer.
+ */
+struct ActuationState {
+  static constexpr uint32_t MAX_HELD_BINDINGS{32};
+
+  float acceleration{0.0f};
+  float steering{0.0f};
+  // CLOCK_MONOTONIC time stamp in microseconds of the oldest input event
+  // that the latest update was based on; 0 if there was no input yet.
+  int64_t inputTimeStamp{0};
+  // Bit i is set while the key of binding i is held; see KeyBindings.
+  uint32_t heldBindings{0};
+  // CLOCK_MONOTONIC time stamps in microseconds when the held keys were pressed.
+  int64_t heldSince[MAX_HELD_BINDINGS]{};
+};
+
+#endif
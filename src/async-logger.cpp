@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "async-logger.hpp"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstring>
+
+AsyncLogger::AsyncLogger(FILE *out) noexcept
+    : m_out(out) {
+  try {
+    m_writer = std::thread([this]() {
+      while (m_running.load()) {
+        if (!drain()) {
+          using namespace std::chrono_literals;
+          std::this_thread::sleep_for(10ms);
+        }
+      }
+    });
+  } catch (...) {
+    m_running.store(false);
+  }
+}
+
+AsyncLogger::~AsyncLogger() noexcept {
+  m_running.store(false);
+  if (m_writer.joinable()) {
+    m_writer.join();
+  }
+  drain();
+  if (0 < dropped()) {
+    std::fprintf(m_out, "[AsyncLogger]: Dropped %llu records.\n", static_cast<unsigned long long>(dropped()));
+    std::fflush(m_out);
+  }
+}
+
+void AsyncLogger::log(const char *format, ...) noexcept {
+  // Format on the stack so that the ring's slot is claimed only for the copy.
+  char text[RECORD_SIZE];
+  va_list args;
+  va_start(args, format);
+  const int32_t length{std::vsnprintf(text, RECORD_SIZE, format, args)};
+  va_end(args);
+  const size_t size{(0 > length) ? 0 : ((static_cast<size_t>(length) < RECORD_SIZE) ? static_cast<size_t>(length) : RECORD_SIZE - 1)};
+  m_ring.push([&text, size](char *data) {
+    std::memcpy(data, text, size);
+    return size;
+  });
+}
+
+uint64_t AsyncLogger::dropped() const noexcept {
+  return m_ring.dropped();
+}
+
+bool AsyncLogger::drain() noexcept {
+  const bool retVal{m_ring.drain([this](const char *text, size_t length) {
+    std::fwrite(text, 1, length, m_out);
+  })};
+  if (retVal) {
+    std::fflush(m_out);
+  }
+  return retVal;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASYNC_LOGGER_HPP
+#define ASYNC_LOGGER_HPP
+
+#include "bounded-mpsc-ring.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+/**
+ * Logger for time-critical threads: log() formats into a preallocated ring
+ * of fixed-size records and returns immediately; a background thread writes
+ * the records to the given stream. When the ring is full, records are
+ * dropped and counted instead of blocking the caller. The ring is a
+ * BoundedMpscRing, so log() may be called from any thread.
+ */
+class AsyncLogger {
+ private:
+  AsyncLogger(const AsyncLogger &) = delete;
+  AsyncLogger(AsyncLogger &&) = delete;
+  AsyncLogger &operator=(const AsyncLogger &) = delete;
+  AsyncLogger &operator=(AsyncLogger &&) = delete;
+
+ public:
+  static constexpr size_t CAPACITY{1024};
+  static constexpr size_t RECORD_SIZE{256};
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param out Stream to write to from the background thread.
+   */
+  explicit AsyncLogger(FILE *out) noexcept;
+
+  /**
+   * Destructor; writes all pending records before returning.
+   */
+  ~AsyncLogger() noexcept;
+
+  /**
+   * This method formats a record like printf and never blocks; longer
+   * records are truncated to RECORD_SIZE.
+   *
+   * @param format printf-style format.
+   */
+  void log(const char *format, ...) noexcept __attribute__((format(printf, 2, 3)));
+
+  /**
+   * @return Number of records dropped because the ring was full.
+   */
+  uint64_t dropped() const noexcept;
+
+ private:
+  bool drain() noexcept;
+
+ private:
+  FILE *m_out{nullptr};
+  BoundedMpscRing<RECORD_SIZE, CAPACITY> m_ring{};
+  std::atomic<bool> m_running{true};
+  std::thread m_writer{};
+};
+
+#endif
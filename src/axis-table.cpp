@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "axis-table.hpp"
+
+#include <algorithm>
+
+AxisTable::AxisTable(int32_t minAxesValue, int32_t maxAxesValue, float atMin, float nearNegativeCenter, float nearPositiveCenter, float atMax)
+    : m_table(UINT16_MAX + 1, 0.0f) {
+  for (int32_t value{INT16_MIN}; value <= INT16_MAX; value++) {
+    float mapped{0.0f};
+    if ((0 > value) && (0 > minAxesValue)) {
+      const float ratio{std::min(1.0f, static_cast<float>(value) / static_cast<float>(minAxesValue))};
+      mapped = nearNegativeCenter + (atMin - nearNegativeCenter) * ratio;
+    } else if ((0 < value) && (0 < maxAxesValue)) {
+      const float ratio{std::min(1.0f, static_cast<float>(value) / static_cast<float>(maxAxesValue))};
+      mapped = nearPositiveCenter + (atMax - nearPositiveCenter) * ratio;
+    }
+    m_table[static_cast<uint16_t>(value - INT16_MIN)] = mapped;
+  }
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AXIS_TABLE_HPP
+#define AXIS_TABLE_HPP
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * This class maps every raw int16 axis position to an actuation value. The
+ * negative and the positive half of the axis each interpolate linearly from
+ * a value next to the center to a value at the end; the center maps to 0.
+ * All 65536 values are computed at construction, so mapping is a table read.
+ */
+class AxisTable {
+ public:
+  /**
+   * Constructor.
+   *
+   * @param minAxesValue Raw position at the negative end.
+   * @param maxAxesValue Raw position at the positive end.
+   * @param atMin Value at the negative end.
+   * @param nearNegativeCenter Value next to the center on the negative half.
+   * @param nearPositiveCenter Value next to the center on the positive half.
+   * @param atMax Value at the positive end.
+   */
+  AxisTable(int32_t minAxesValue, int32_t maxAxesValue, float atMin, float nearNegativeCenter, float nearPositiveCenter, float atMax);
+
+  /**
+   * @param value Raw axis position.
+   * @return Actuation value.
+   */
+  float map(int16_t value) const noexcept {
+    return m_table[static_cast<uint16_t>(static_cast<int32_t>(value) - INT16_MIN)];
+  }
+
+ private:
+  std::vector<float> m_table;
+};
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOUNDED_MPSC_RING_HPP
+#define BOUNDED_MPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Bounded multi-producer/single-consumer queue of fixed-size byte slots.
+ * Producers claim a slot with a single compare-and-swap and never block;
+ * when the ring is full, the item is dropped and counted instead. Every
+ * slot carries a sequence number that tells whether it is free, being
+ * written, or ready to be consumed, so the consumer never waits either.
+ */
+template <size_t SLOT_SIZE, size_t CAPACITY>
+class BoundedMpscRing {
+ private:
+  BoundedMpscRing(const BoundedMpscRing &) = delete;
+  BoundedMpscRing(BoundedMpscRing &&) = delete;
+  BoundedMpscRing &operator=(const BoundedMpscRing &) = delete;
+  BoundedMpscRing &operator=(BoundedMpscRing &&) = delete;
+
+  static_assert(0 == (CAPACITY & (CAPACITY - 1)), "CAPACITY must be a power of two.");
+
+ public:
+  BoundedMpscRing() noexcept {
+    for (size_t i{0}; i < CAPACITY; i++) {
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * This method claims a slot and lets the producer fill it; it may be
+   * called from any thread.
+   *
+   * @param fill Called as size_t fill(char *data) with SLOT_SIZE bytes; returns the number of bytes used.
+   * @return false if the ring was full and the item was dropped.
+   */
+  template <typename Fill>
+  bool push(Fill &&fill) noexcept {
+    // A slot is free when its sequence equals the write position.
+    size_t position{m_writePosition.load(std::memory_order_relaxed)};
+    Slot *slot{nullptr};
+    while (nullptr == slot) {
+      Slot &candidate = m_slots[position & (CAPACITY - 1)];
+      const size_t sequence{candidate.sequence.load(std::memory_order_acquire)};
+      if (sequence == position) {
+        if (m_writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          slot = &candidate;
+        }
+      } else if (sequence < position) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        position = m_writePosition.load(std::memory_order_relaxed);
+      }
+    }
+    const size_t length{fill(slot->data)};
+    slot->length = (length < SLOT_SIZE) ? length : SLOT_SIZE;
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * This method hands all ready slots in order to the consumer; only to be
+   * called by the single consumer thread.
+   *
+   * @param consume Called as consume(const char *data, size_t length) for every slot.
+   * @return true if at least one slot was consumed.
+   */
+  template <typename Consume>
+  bool drain(Consume &&consume) noexcept {
+    bool retVal{false};
+    while (true) {
+      Slot &slot = m_slots[m_readPosition & (CAPACITY - 1)];
+      if (slot.sequence.load(std::memory_order_acquire) != m_readPosition + 1) {
+        break;
+      }
+      consume(static_cast<const char *>(slot.data), slot.length);
+      slot.sequence.store(m_readPosition + CAPACITY, std::memory_order_release);
+      m_readPosition++;
+      retVal = true;
+    }
+    return retVal;
+  }
+
+  /**
+   * @return Number of items dropped because the ring was full.
+   */
+  uint64_t dropped() const noexcept {
+    return m_dropped.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    size_t length;
+    char data[SLOT_SIZE];
+  };
+
+  Slot m_slots[CAPACITY]{};
+  alignas(64) std::atomic<size_t> m_writePosition{0};
+  alignas(64) size_t m_readPosition{0};
+  std::atomic<uint64_t> m_dropped{0};
+};
+
+#endif
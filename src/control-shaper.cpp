@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "control-shaper.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+ControlShaper::ControlShaper(const ShapingConfig &acceleration, const ShapingConfig &steering) noexcept
+    : m_acceleration(makeChannel(acceleration))
+    , m_steering(makeChannel(steering)) {}
+
+ShapingConfig ControlShaper::fromCommandline(std::map<std::string, std::string> &commandlineArguments,
+                                             const std::string &prefix, float min, float max) {
+  auto get = [&commandlineArguments, &prefix](const std::string &name) {
+    const std::string key{prefix + "_" + name};
+    return (commandlineArguments.count(key) != 0) ? std::stof(commandlineArguments[key]) : 0.0f;
+  };
+  ShapingConfig retVal;
+  retVal.deadband = get("deadband");
+  retVal.timeConstant = get("smoothing");
+  retVal.maxRate = get("max_rate");
+  retVal.maxJerk = get("max_jerk");
+  retVal.min = std::min(min, max);
+  retVal.max = std::max(min, max);
+  return retVal;
+}
+
+void ControlShaper::apply(float dt, float &acceleration, float &steering) noexcept {
+  if (0.0f < dt) {
+    acceleration = shape(m_acceleration, acceleration, dt);
+    steering = shape(m_steering, steering, dt);
+  }
+}
+
+void ControlShaper::reset(float acceleration, float steering) noexcept {
+  m_acceleration.smoothed = m_acceleration.value = acceleration;
+  m_steering.smoothed = m_steering.value = steering;
+  m_acceleration.rate = m_steering.rate = 0.0f;
+}
+
+uint8_t ControlShaper::accelerationStages() const noexcept {
+  return m_acceleration.stages;
+}
+
+uint8_t ControlShaper::steeringStages() const noexcept {
+  return m_steering.stages;
+}
+
+ControlShaper::Channel ControlShaper::makeChannel(const ShapingConfig &config) noexcept {
+  uint8_t stages{0};
+  stages |= (0.0f < config.deadband) ? DEADBAND : 0;
+  stages |= (0.0f < config.timeConstant) ? SMOOTHING : 0;
+  stages |= (0.0f < config.maxRate) ? RATE_LIMIT : 0;
+  stages |= (0.0f < config.maxJerk) ? JERK_LIMIT : 0;
+  stages |= (config.min < config.max) ? SATURATION : 0;
+  return Channel{config, stages, 0.0f, 0.0f, 0.0f};
+}
+
+float ControlShaper::shape(Channel &channel, float input, float dt) noexcept {
+  const ShapingConfig &config{channel.config};
+  float target{input};
+  if (channel.stages & DEADBAND) {
+    target = (std::fabs(target) < config.deadband) ? 0.0f : target;
+  }
+  if (channel.stages & SMOOTHING) {
+    // First-order low pass; dt / (tau + dt) is stable for any dt.
+    channel.smoothed += (target - channel.smoothed) * (dt / (config.timeConstant + dt));
+    target = channel.smoothed;
+  }
+
+  if (channel.stages & (RATE_LIMIT | JERK_LIMIT)) {
+    const float error{target - channel.value};
+    float rate{error / dt};
+    if (channel.stages & RATE_LIMIT) {
+      rate = std::min(std::max(rate, -config.maxRate), config.maxRate);
+    }
+    if (channel.stages & JERK_LIMIT) {
+      // Do not move faster than the jerk limit allows to slow down in time.
+      const float stoppingRate{std::sqrt(2.0f * config.maxJerk * std::fabs(error))};
+      rate = std::min(std::max(rate, -stoppingRate), stoppingRate);
+      const float maxChange{config.maxJerk * dt};
+      rate = std::min(std::max(rate, channel.rate - maxChange), channel.rate + maxChange);
+    }
+    channel.rate = rate;
+    channel.value += rate * dt;
+  } else {
+    channel.value = target;
+  }
+
+  if (channel.stages & SATURATION) {
+    channel.value = std::min(std::max(channel.value, config.min), config.max);
+  }
+  return channel.value;
+}
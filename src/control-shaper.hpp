@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CONTROL_SHAPER_HPP
+#define CONTROL_SHAPER_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * Configuration of the filters for one actuation channel; a filter is
+ * disabled when its parameter is not positive.
+ */
+struct ShapingConfig {
+  // Inputs with a smaller magnitude are treated as 0.
+  float deadband{0.0f};
+  // Time constant of the exponential smoothing in s.
+  float timeConstant{0.0f};
+  // Maximum rate of change per s.
+  float maxRate{0.0f};
+  // Maximum change of the rate per s^2.
+  float maxJerk{0.0f};
+  float min{0.0f};
+  float max{0.0f};
+};
+
+/**
+ * This class shapes acceleration and steering with a fixed chain of filters:
+ * deadband, exponential smoothing, rate and jerk limit, and saturation. The
+ * chain is resolved once at construction into a bitmask of enabled stages,
+ * so apply() runs all stages of both channels in one pass over a fixed-size
+ * state without allocation or indirect calls.
+ */
+class ControlShaper {
+ public:
+  enum Stage : uint8_t {
+    DEADBAND = 1 << 0,
+    SMOOTHING = 1 << 1,
+    RATE_LIMIT = 1 << 2,
+    JERK_LIMIT = 1 << 3,
+    SATURATION = 1 << 4,
+  };
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param acceleration Configuration for acceleration.
+   * @param steering Configuration for steering.
+   */
+  ControlShaper(const ShapingConfig &acceleration, const ShapingConfig &steering) noexcept;
+
+  /**
+   * This method reads the configuration of one channel from the command line
+   * arguments <prefix>_deadband, <prefix>_smoothing, <prefix>_max_rate, and
+   * <prefix>_max_jerk.
+   *
+   * @param commandlineArguments Parsed command line arguments.
+   * @param prefix Prefix of the channel's arguments.
+   * @param min Lower saturation limit.
+   * @param max Upper saturation limit.
+   * @return Configuration of the channel.
+   */
+  static ShapingConfig fromCommandline(std::map<std::string, std::string> &commandlineArguments,
+                                       const std::string &prefix, float min, float max);
+
+  /**
+   * This method shapes the given values in place.
+   *
+   * @param dt Time since the previous call in s.
+   * @param acceleration Acceleration to shape.
+   * @param steering Steering to shape.
+   */
+  void apply(float dt, float &acceleration, float &steering) noexcept;
+
+  /**
+   * This method sets the output of both channels, e.g. after a stop.
+   *
+   * @param acceleration Acceleration to continue from.
+   * @param steering Steering to continue from.
+   */
+  void reset(float acceleration, float steering) noexcept;
+
+  /**
+   * @return Bitmask of the enabled stages of the acceleration channel.
+   */
+  uint8_t accelerationStages() const noexcept;
+
+  /**
+   * @return Bitmask of the enabled stages of the steering channel.
+   */
+  uint8_t steeringStages() const noexcept;
+
+ private:
+  struct Channel {
+    ShapingConfig config;
+    uint8_t stages;
+    float smoothed;
+    float value;
+    float rate;
+  };
+
+  static Channel makeChannel(const ShapingConfig &config) noexcept;
+  static float shape(Channel &channel, float input, float dt) noexcept;
+
+ private:
+  Channel m_acceleration;
+  Channel m_steering;
+};
+
+#endif
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cluon-complete.hpp"
+#include "deadline-scheduler.hpp"
+#include "monotonic-time.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+
+DeadlineScheduler::DeadlineScheduler() noexcept {
+  m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+  m_stopFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if ((-1 != m_epollFd) && (-1 != m_stopFd)) {
+    struct epoll_event ev{};
+    ev.events = EPOLLIN;
+    // Tag the stop descriptor with an index that no trigger can have.
+    ev.data.u64 = UINT64_MAX;
+    if (0 != ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_stopFd, &ev)) {
+      ::close(m_stopFd);
+      m_stopFd = -1;
+    }
+  }
+}
+
+DeadlineScheduler::~DeadlineScheduler() noexcept {
+  for (auto &trigger : m_triggers) {
+    ::close(trigger.fd);
+  }
+  if (-1 != m_stopFd) {
+    ::close(m_stopFd);
+  }
+  if (-1 != m_epollFd) {
+    ::close(m_epollFd);
+  }
+}
+
+bool DeadlineScheduler::isValid() const noexcept {
+  return (-1 != m_epollFd) && (-1 != m_stopFd);
+}
+
+int32_t DeadlineScheduler::add(float freq, CatchUpPolicy policy, std::function<bool()> delegate) noexcept {
+  int32_t retVal{-1};
+  if (isValid() && (0.0f < freq) && (nullptr != delegate)) {
+    const int32_t fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (-1 != fd) {
+      // The kernel places all following deadlines relative to the first one.
+      const int64_t PERIOD_IN_NANOSECONDS{std::max<int64_t>(1, std::llround(1000.0 * 1000.0 * 1000.0 / static_cast<double>(freq)))};
+      const int64_t first{monotonic::nowInNanoseconds() + PERIOD_IN_NANOSECONDS};
+
+      struct itimerspec spec{};
+      spec.it_interval.tv_sec = static_cast<time_t>(PERIOD_IN_NANOSECONDS / (1000 * 1000 * 1000));
+      spec.it_interval.tv_nsec = static_cast<long>(PERIOD_IN_NANOSECONDS % (1000 * 1000 * 1000));
+      spec.it_value.tv_sec = static_cast<time_t>(first / (1000 * 1000 * 1000));
+      spec.it_value.tv_nsec = static_cast<long>(first % (1000 * 1000 * 1000));
+
+      struct epoll_event ev{};
+      ev.events = EPOLLIN;
+      ev.data.u64 = m_triggers.size();
+      if ((0 == ::timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, nullptr)) &&
+          (0 == ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev))) {
+        try {
+          m_triggers.push_back(Trigger{fd, policy, std::move(delegate), PERIOD_IN_NANOSECONDS, first, 0, std::make_unique<TriggerStatistics>()});
+          retVal = static_cast<int32_t>(m_triggers.size() - 1);
+        } catch (...) {} // LCOV_EXCL_LINE
+      }
+      if (-1 == retVal) {
+        ::close(fd);
+      }
+    }
+  }
+  return retVal;
+}
+
+bool DeadlineScheduler::watch(int32_t fd, std::function<bool()> delegate) noexcept {
+  bool retVal{false};
+  if (isValid() && (-1 != fd) && (nullptr != delegate)) {
+    try {
+      struct epoll_event ev{};
+      ev.events = EPOLLIN;
+      // Watches are tagged above all trigger indices.
+      ev.data.u64 = WATCH_TAG | m_watches.size();
+      m_watches.push_back(std::move(delegate));
+      retVal = (0 == ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev));
+      if (!retVal) {
+        m_watches.pop_back();
+      }
+    } catch (...) {} // LCOV_EXCL_LINE
+  }
+  return retVal;
+}
+
+void DeadlineScheduler::run() noexcept {
+  constexpr int32_t MAX_EVENTS{16};
+  struct epoll_event events[MAX_EVENTS];
+  while (isValid() && !m_stopped.load() && !cluon::TerminateHandler::instance().isTerminated.load()) {
+    const int32_t n = ::epoll_wait(m_epollFd, events, MAX_EVENTS, -1);
+    if (0 > n) {
+      if (EINTR == errno) {
+        continue;
+      }
+      break;
+    }
+    for (int32_t i{0}; (i < n) && !m_stopped.load(); i++) {
+      const uint64_t index{events[i].data.u64};
+      if (index < m_triggers.size()) {
+        if (!onTimer(m_triggers[index])) {
+          m_stopped.store(true);
+        }
+      } else if ((UINT64_MAX != index) && ((index & ~WATCH_TAG) < m_watches.size())) {
+        bool retVal{false};
+        try {
+          retVal = m_watches[index & ~WATCH_TAG]();
+        } catch (...) {} // delegate threw exception.
+        if (!retVal) {
+          m_stopped.store(true);
+        }
+      }
+    }
+  }
+}
+
+void DeadlineScheduler::stop() noexcept {
+  m_stopped.store(true);
+  if (-1 != m_stopFd) {
+    const uint64_t one{1};
+    ssize_t const written = ::write(m_stopFd, &one, sizeof(one));
+    (void)written;
+  }
+}
+
+const TriggerStatistics *DeadlineScheduler::statistics(int32_t index) const noexcept {
+  return ((0 <= index) && (static_cast<size_t>(index) < m_triggers.size())) ? m_triggers[static_cast<size_t>(index)].statistics.get() : nullptr;
+}
+
+bool DeadlineScheduler::onTimer(Trigger &trigger) noexcept {
+  // The timerfd counts the deadlines that passed since it was read last.
+  uint64_t expirations{0};
+  if (static_cast<ssize_t>(sizeof(expirations)) != ::read(trigger.fd, &expirations, sizeof(expirations))) {
+    return true;
+  }
+  const int64_t now{monotonic::nowInNanoseconds()};
+  TriggerStatistics &statistics{*trigger.statistics};
+  statistics.missedTicks += expirations - 1;
+
+  // Lateness is measured against the latest deadline that has passed.
+  const int64_t passed{static_cast<int64_t>(expirations)};
+  statistics.lateness.record(now - (trigger.nextDeadline + (passed - 1) * trigger.period));
+  if (0 != trigger.lastWakeup) {
+    statistics.periodError.record(std::llabs((now - trigger.lastWakeup) - passed * trigger.period));
+  }
+  trigger.nextDeadline += passed * trigger.period;
+  trigger.lastWakeup = now;
+
+  uint64_t calls{1};
+  if (CatchUpPolicy::BURST == trigger.policy) {
+    calls = std::min(expirations, MAX_BURST);
+  }
+
+  bool retVal{true};
+  for (uint64_t i{0}; (i < calls) && retVal; i++) {
+    statistics.ticks++;
+    const int64_t before{monotonic::nowInNanoseconds()};
+    try {
+      retVal = trigger.delegate();
+    } catch (...) {
+      retVal = false; // delegate threw exception.
+    }
+    statistics.executionTime.record(monotonic::nowInNanoseconds() - before);
+  }
+  return retVal;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEADLINE_SCHEDULER_HPP
+#define DEADLINE_SCHEDULER_HPP
+
+#include "latency-histogram.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * Policy how a trigger handles ticks that were missed because a delegate
+ * (or the whole process) was late.
+ */
+enum class CatchUpPolicy {
+  SKIP,  // Call the delegate once and continue with the next deadline.
+  BURST, // Call the delegate for every missed tick, up to MAX_BURST times.
+};
+
+/**
+ * Timing statistics of one trigger; all times are in nanoseconds. They are
+ * updated without allocation and can be read from any thread at any time.
+ */
+struct TriggerStatistics {
+  std::atomic<uint64_t> ticks{0};
+  // Deadlines that had already passed when the trigger woke up.
+  std::atomic<uint64_t> missedTicks{0};
+  // Time from the deadline until the delegate started.
+  LatencyHistogram lateness{};
+  // Deviation of the time between two wakeups from the expected one.
+  LatencyHistogram periodError{};
+  // Time spent in the delegate per call.
+  LatencyHistogram executionTime{};
+};
+
+/**
+ * This class calls delegates time-triggered like cluon::OD4Session::timeTrigger
+ * but waits for absolute CLOCK_MONOTONIC deadlines with a timerfd each. Thus,
+ * the period has nanosecond resolution, does not drift with the delegate's
+ * execution time, and is not skewed when the wall clock is stepped.
+ */
+class DeadlineScheduler {
+ private:
+  DeadlineScheduler(const DeadlineScheduler &) = delete;
+  DeadlineScheduler(DeadlineScheduler &&) = delete;
+  DeadlineScheduler &operator=(const DeadlineScheduler &) = delete;
+  DeadlineScheduler &operator=(DeadlineScheduler &&) = delete;
+
+ public:
+  static constexpr uint64_t MAX_BURST{8};
+
+ public:
+  DeadlineScheduler() noexcept;
+  ~DeadlineScheduler() noexcept;
+
+  /**
+   * @return True if the epoll instance could be created.
+   */
+  bool isValid() const noexcept;
+
+  /**
+   * This method adds a delegate to be called with the given frequency.
+   *
+   * @param freq Frequency in Hertz.
+   * @param policy How to handle missed ticks.
+   * @param delegate Function to call; returning false ends run().
+   * @return Index of the trigger or -1 in case of an error.
+   */
+  int32_t add(float freq, CatchUpPolicy policy, std::function<bool()> delegate) noexcept;
+
+  /**
+   * This method adds a delegate to be called whenever the given file
+   * descriptor becomes readable, e.g. a one-shot timerfd that must be
+   * handled between two ticks. The caller keeps ownership of the descriptor.
+   *
+   * @param fd File descriptor to wait for.
+   * @param delegate Function to call; it must consume the readiness; returning false ends run().
+   * @return True if the descriptor could be added.
+   */
+  bool watch(int32_t fd, std::function<bool()> delegate) noexcept;
+
+  /**
+   * This method blocks until a delegate returns false, stop() is called,
+   * or the process is terminated.
+   */
+  void run() noexcept;
+
+  /**
+   * This method can be called from any thread to make run() return.
+   */
+  void stop() noexcept;
+
+  /**
+   * @param index Index of the trigger.
+   * @return Statistics of the trigger or nullptr for an invalid index.
+   */
+  const TriggerStatistics *statistics(int32_t index) const noexcept;
+
+ private:
+  struct Trigger {
+    int32_t fd;
+    CatchUpPolicy policy;
+    std::function<bool()> delegate;
+    int64_t period;
+    int64_t nextDeadline;
+    int64_t lastWakeup;
+    std::unique_ptr<TriggerStatistics> statistics;
+  };
+
+  bool onTimer(Trigger &trigger) noexcept;
+
+  static constexpr uint64_t WATCH_TAG{1ull << 32};
+
+ private:
+  int32_t m_epollFd{-1};
+  int32_t m_stopFd{-1};
+  std::atomic<bool> m_stopped{false};
+  std::vector<Trigger> m_triggers{};
+  std::vector<std::function<bool()>> m_watches{};
+};
+
+#endif
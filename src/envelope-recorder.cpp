@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "envelope-recorder.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+EnvelopeRecorder::EnvelopeRecorder(const std::string &file) noexcept {
+  m_out = std::fopen(file.c_str(), "wb");
+  if (nullptr == m_out) {
+    std::cerr << "[EnvelopeRecorder]: Cannot create " << file << "." << std::endl;
+    return;
+  }
+  // Only full buffers are written while envelopes keep arriving.
+  m_buffer = static_cast<char *>(std::malloc(BUFFER_SIZE));
+  if (nullptr != m_buffer) {
+    std::setvbuf(m_out, m_buffer, _IOFBF, BUFFER_SIZE);
+  }
+  try {
+    m_writer = std::thread([this]() {
+      // Besides whenever the stdio buffer is full, written envelopes reach
+      // the file at most FLUSH_INTERVAL late and once more when destroyed.
+      const auto FLUSH_INTERVAL{std::chrono::seconds(1)};
+      auto lastFlush{std::chrono::steady_clock::now()};
+      bool hasUnflushed{false};
+      while (m_running.load()) {
+        const bool hasDrained{drain()};
+        hasUnflushed = hasUnflushed || hasDrained;
+        const auto now{std::chrono::steady_clock::now()};
+        if (hasUnflushed && (FLUSH_INTERVAL <= now - lastFlush)) {
+          std::fflush(m_out);
+          lastFlush = now;
+          hasUnflushed = false;
+        }
+        if (!hasDrained) {
+          using namespace std::chrono_literals;
+          std::this_thread::sleep_for(10ms);
+        }
+      }
+    });
+  } catch (...) {
+    m_running.store(false);
+  }
+}
+
+EnvelopeRecorder::~EnvelopeRecorder() noexcept {
+  m_running.store(false);
+  if (m_writer.joinable()) {
+    m_writer.join();
+  }
+  if (nullptr != m_out) {
+    drain();
+    std::fclose(m_out);
+  }
+  std::free(m_buffer);
+  if (0 < dropped()) {
+    std::cerr << "[EnvelopeRecorder]: Dropped " << dropped() << " envelopes because the ring was full." << std::endl;
+  }
+  if (0 < oversized()) {
+    std::cerr << "[EnvelopeRecorder]: Dropped " << oversized() << " envelopes larger than " << RECORD_SIZE << " bytes." << std::endl;
+  }
+}
+
+bool EnvelopeRecorder::isValid() const noexcept {
+  return (nullptr != m_out) && m_running.load();
+}
+
+void EnvelopeRecorder::record(const std::string &data) noexcept {
+  if (RECORD_SIZE < data.size()) {
+    m_oversized.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  m_ring.push([&data](char *buffer) {
+    std::memcpy(buffer, data.data(), data.size());
+    return data.size();
+  });
+}
+
+uint64_t EnvelopeRecorder::dropped() const noexcept {
+  return m_ring.dropped();
+}
+
+uint64_t EnvelopeRecorder::oversized() const noexcept {
+  return m_oversized.load(std::memory_order_relaxed);
+}
+
+bool EnvelopeRecorder::drain() noexcept {
+  return m_ring.drain([this](const char *data, size_t length) {
+    std::fwrite(data, 1, length, m_out);
+  });
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENVELOPE_RECORDER_HPP
+#define ENVELOPE_RECORDER_HPP
+
+#include "bounded-mpsc-ring.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+/**
+ * Recorder for the serialized envelopes that this process sends. record()
+ * copies the bytes into a BoundedMpscRing like AsyncLogger::log() and never
+ * blocks; a background thread appends them to a .rec file through a large
+ * stdio buffer, flushes it at most once per second, and never calls fsync. Envelopes that do not fit into a
+ * record or arrive while the ring is full are dropped, so that the file only
+ * contains complete envelopes; both cases are counted separately and
+ * reported when the recorder is destroyed.
+ */
+class EnvelopeRecorder {
+ private:
+  EnvelopeRecorder(const EnvelopeRecorder &) = delete;
+  EnvelopeRecorder(EnvelopeRecorder &&) = delete;
+  EnvelopeRecorder &operator=(const EnvelopeRecorder &) = delete;
+  EnvelopeRecorder &operator=(EnvelopeRecorder &&) = delete;
+
+ public:
+  static constexpr size_t CAPACITY{4096};
+  static constexpr size_t RECORD_SIZE{256};
+  static constexpr size_t BUFFER_SIZE{1024 * 1024};
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param file .rec file to create.
+   */
+  explicit EnvelopeRecorder(const std::string &file) noexcept;
+
+  /**
+   * Destructor; writes all pending envelopes before returning.
+   */
+  ~EnvelopeRecorder() noexcept;
+
+  /**
+   * @return True if the file could be created.
+   */
+  bool isValid() const noexcept;
+
+  /**
+   * This method queues one envelope as returned by cluon::serializeEnvelope.
+   *
+   * @param data Serialized envelope.
+   */
+  void record(const std::string &data) noexcept;
+
+  /**
+   * @return Number of envelopes dropped because the ring was full.
+   */
+  uint64_t dropped() const noexcept;
+
+  /**
+   * @return Number of envelopes dropped because they were larger than RECORD_SIZE.
+   */
+  uint64_t oversized() const noexcept;
+
+ private:
+  bool drain() noexcept;
+
+ private:
+  FILE *m_out{nullptr};
+  char *m_buffer{nullptr};
+  BoundedMpscRing<RECORD_SIZE, CAPACITY> m_ring{};
+  std::atomic<uint64_t> m_oversized{0};
+  std::atomic<bool> m_running{true};
+  std::thread m_writer{};
+};
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "evdev-input-backend.hpp"
+#include "monotonic-time.hpp"
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+// Older kernel headers do not provide these accessors yet.
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+
+EvdevInputBackend::EvdevInputBackend(const std::string &device, bool grab, KeyDelegate delegate) noexcept
+    : m_delegate(std::move(delegate)) {
+  m_fd = ::open(device.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (-1 == m_fd) {
+    std::cerr << "[EvdevInputBackend]: Cannot open " << device << ": " << ::strerror(errno) << std::endl;
+    return;
+  }
+
+  // Kernel time stamps shall use the same clock as the rest of the service.
+  int clockId{CLOCK_MONOTONIC};
+  m_hasMonotonicTimeStamps = (0 == ::ioctl(m_fd, EVIOCSCLOCKID, &clockId));
+
+  if (grab && (0 != ::ioctl(m_fd, EVIOCGRAB, 1))) {
+    std::cerr << "[EvdevInputBackend]: Cannot grab " << device << ": " << ::strerror(errno) << std::endl;
+  }
+}
+
+EvdevInputBackend::~EvdevInputBackend() noexcept {
+  if (-1 != m_fd) {
+    ::close(m_fd);
+  }
+}
+
+bool EvdevInputBackend::isValid() const noexcept {
+  return (-1 != m_fd);
+}
+
+int32_t EvdevInputBackend::fileDescriptor() const noexcept {
+  return m_fd;
+}
+
+bool EvdevInputBackend::readEvents() noexcept {
+  constexpr size_t MAX_EVENTS{64};
+  struct input_event events[MAX_EVENTS];
+  if (!m_isSynchronized) {
+    // Report keys that are already held down from the first read so that
+    // they are published like any other event instead of during construction.
+    m_isSynchronized = true;
+    synchronize();
+  }
+  while (true) {
+    const ssize_t bytesRead = ::read(m_fd, events, sizeof(events));
+    if (0 > bytesRead) {
+      if (EINTR == errno) {
+        continue;
+      }
+      // EAGAIN means drained; anything else (e.g. ENODEV) means the device is gone.
+      return (EAGAIN == errno) || (EWOULDBLOCK == errno);
+    }
+    if (0 == bytesRead) {
+      return false;
+    }
+
+    const size_t count{static_cast<size_t>(bytesRead) / sizeof(struct input_event)};
+    for (size_t i{0}; i < count; i++) {
+      const struct input_event &ev = events[i];
+      if (EV_SYN == ev.type) {
+        if (SYN_DROPPED == ev.code) {
+          // The kernel's buffer overflowed; discard until the next report and resynchronize.
+          m_isDropping = true;
+        } else if ((SYN_REPORT == ev.code) && m_isDropping) {
+          m_isDropping = false;
+          synchronize();
+        }
+      } else if (!m_isDropping && (EV_KEY == ev.type) && (ev.code < KEY_CNT) && (2 != ev.value)) {
+        // Value 2 is autorepeat which does not change the key's state.
+        const bool pressed{1 == ev.value};
+        if (m_pressed[ev.code] != pressed) {
+          m_pressed[ev.code] = pressed;
+          const int64_t timeStamp{m_hasMonotonicTimeStamps
+              ? static_cast<int64_t>(ev.input_event_sec) * 1000 * 1000 + static_cast<int64_t>(ev.input_event_usec)
+              : monotonic::nowInMicroseconds()};
+          m_delegate(ev.code, pressed, timeStamp);
+        }
+      }
+    }
+
+    // A short read means that the kernel's queue is empty.
+    if (count < MAX_EVENTS) {
+      break;
+    }
+  }
+  return true;
+}
+
+bool EvdevInputBackend::probe() noexcept {
+  // Fails with ENODEV once the device is unplugged.
+  int32_t version{0};
+  return (0 == ::ioctl(m_fd, EVIOCGVERSION, &version));
+}
+
+void EvdevInputBackend::synchronize() noexcept {
+  uint8_t keys[KEY_CNT / 8 + 1];
+  std::memset(keys, 0, sizeof(keys));
+  if (0 > ::ioctl(m_fd, EVIOCGKEY(sizeof(keys)), keys)) {
+    return;
+  }
+
+  const int64_t now{monotonic::nowInMicroseconds()};
+  for (uint16_t code{0}; code < KEY_CNT; code++) {
+    const bool pressed{0 != (keys[code / 8] & (1 << (code % 8)))};
+    if (m_pressed[code] != pressed) {
+      m_pressed[code] = pressed;
+      m_delegate(code, pressed, now);
+    }
+  }
+}
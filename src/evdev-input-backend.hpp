@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVDEV_INPUT_BACKEND_HPP
+#define EVDEV_INPUT_BACKEND_HPP
+
+#include "input-backend.hpp"
+
+#include <linux/input.h>
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+
+/**
+ * This class reads key events directly from a Linux event device
+ * (/dev/input/event*) and therefore does not need an X server.
+ */
+class EvdevInputBackend : public InputBackend {
+ private:
+  EvdevInputBackend(const EvdevInputBackend &) = delete;
+  EvdevInputBackend(EvdevInputBackend &&) = delete;
+  EvdevInputBackend &operator=(const EvdevInputBackend &) = delete;
+  EvdevInputBackend &operator=(EvdevInputBackend &&) = delete;
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param device Event device to open.
+   * @param grab If true, the device is grabbed so that no other client receives its events.
+   * @param delegate Function to call for every key transition.
+   */
+  EvdevInputBackend(const std::string &device, bool grab, KeyDelegate delegate) noexcept;
+  ~EvdevInputBackend() noexcept override;
+
+  bool isValid() const noexcept override;
+  int32_t fileDescriptor() const noexcept override;
+  bool readEvents() noexcept override;
+  bool probe() noexcept override;
+
+ private:
+  void synchronize() noexcept;
+
+ private:
+  KeyDelegate m_delegate{nullptr};
+  int32_t m_fd{-1};
+  bool m_hasMonotonicTimeStamps{false};
+  bool m_isDropping{false};
+  bool m_isSynchronized{false};
+  std::bitset<KEY_CNT> m_pressed{};
+};
+
+#endif
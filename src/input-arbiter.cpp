@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input-arbiter.hpp"
+
+InputArbiter::InputArbiter(uint32_t devices, Arbitration arbitration, const KeyBindings &keyBindings, const std::vector<uint16_t> &overrideKeys)
+    : m_arbitration(arbitration)
+    , m_keyBindings(keyBindings)
+    , m_states((devices < MAX_DEVICES) ? devices : MAX_DEVICES)
+    , m_heldOverrideKeys(m_states.size(), 0)
+    , m_deflectedAxes(m_states.size(), 0)
+    , m_activeSince(m_states.size(), 0) {
+  for (uint16_t code : overrideKeys) {
+    if (code < KEY_CNT) {
+      m_overrideKeys.set(code);
+    }
+  }
+}
+
+bool InputArbiter::onKey(uint32_t device, uint16_t code, bool pressed, int64_t timeStamp) noexcept {
+  if (device >= m_states.size()) {
+    return false;
+  }
+  const bool hasStateChanged{m_keyBindings.onKey(code, pressed, timeStamp, m_states[device])};
+  bool isOverrideKey{false};
+  if ((code < KEY_CNT) && m_overrideKeys.test(code)) {
+    // Key repeats are filtered by the backends; thus, presses and releases alternate.
+    uint8_t &held{m_heldOverrideKeys[device]};
+    held = pressed ? static_cast<uint8_t>(held + 1) : static_cast<uint8_t>((0 < held) ? held - 1 : 0);
+    isOverrideKey = true;
+  }
+  return (hasStateChanged || isOverrideKey) && arbitrate(device, hasStateChanged, timeStamp);
+}
+
+bool InputArbiter::onAxis(uint32_t device, Axis axis, float value, bool isDeflected, int64_t timeStamp) noexcept {
+  if (device >= m_states.size()) {
+    return false;
+  }
+  ActuationState &state{m_states[device]};
+  float &actuation{(Axis::STEERING == axis) ? state.steering : state.acceleration};
+  const bool hasStateChanged{(actuation < value) || (value < actuation)};
+  actuation = value;
+  const uint8_t bit{static_cast<uint8_t>(1 << static_cast<uint8_t>(axis))};
+  m_deflectedAxes[device] = isDeflected ? (m_deflectedAxes[device] | bit) : (m_deflectedAxes[device] & ~bit);
+  return arbitrate(device, hasStateChanged, timeStamp);
+}
+
+const ActuationState &InputArbiter::state() const noexcept {
+  return (0 <= m_owner) ? m_states[static_cast<uint32_t>(m_owner)] : m_idle;
+}
+
+int32_t InputArbiter::owner() const noexcept {
+  return m_owner;
+}
+
+bool InputArbiter::arbitrate(uint32_t device, bool hasStateChanged, int64_t timeStamp) noexcept {
+  const uint32_t bit{1u << device};
+  const bool isActive{(0 != m_states[device].heldBindings) || (0 != m_deflectedAxes[device])};
+  if (isActive && (0 == (m_active & bit))) {
+    m_activeSince[device] = timeStamp;
+  }
+  m_active = isActive ? (m_active | bit) : (m_active & ~bit);
+  m_overriding = (0 < m_heldOverrideKeys[device]) ? (m_overriding | bit) : (m_overriding & ~bit);
+
+  const int32_t previousOwner{m_owner};
+  // Devices are ordered by priority, so the lowest set bit wins.
+  if (0 != m_overriding) {
+    m_owner = __builtin_ctz(m_overriding);
+  } else if ((Arbitration::FIRST_WINS == m_arbitration) && (0 <= m_owner) && (0 != (m_active & (1u << m_owner)))) {
+    // The owner keeps control.
+  } else if (Arbitration::FIRST_WINS == m_arbitration) {
+    // Hand control to the device that became active earliest; ties go to the higher priority.
+    m_owner = -1;
+    for (uint32_t active{m_active}; 0 != active; active &= active - 1) {
+      const int32_t candidate{__builtin_ctz(active)};
+      if ((0 > m_owner) || (m_activeSince[static_cast<uint32_t>(candidate)] < m_activeSince[static_cast<uint32_t>(m_owner)])) {
+        m_owner = candidate;
+      }
+    }
+  } else {
+    m_owner = (0 != m_active) ? __builtin_ctz(m_active) : -1;
+  }
+  // Without an owner, the idle state is reported whatever the devices do.
+  return (previousOwner != m_owner) || (hasStateChanged && (static_cast<int32_t>(device) == m_owner));
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INPUT_ARBITER_HPP
+#define INPUT_ARBITER_HPP
+
+#include "actuation-state.hpp"
+#include "key-bindings.hpp"
+
+#include <linux/input.h>
+
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Policy which of several active input devices controls the vehicle.
+ */
+enum class Arbitration {
+  PRIORITY,   // The active device that was given first controls.
+  FIRST_WINS, // The device that became active first keeps control until it is idle.
+};
+
+/**
+ * This class keeps one ActuationState per input device and selects the one
+ * that controls the vehicle. A device is active while one of its bound keys
+ * is held or one of its axes is deflected. A device holding an override key
+ * takes control from all others. Every event is arbitrated with bit
+ * operations on masks of at most MAX_DEVICES devices; only when the owner
+ * becomes idle under FIRST_WINS, the active devices' activation times are
+ * compared to hand control to the one that became active earliest.
+ */
+class InputArbiter {
+ private:
+  InputArbiter(const InputArbiter &) = delete;
+  InputArbiter(InputArbiter &&) = delete;
+  InputArbiter &operator=(const InputArbiter &) = delete;
+  InputArbiter &operator=(InputArbiter &&) = delete;
+
+ public:
+  static constexpr uint32_t MAX_DEVICES{32};
+
+  enum class Axis : uint8_t { STEERING = 0, ACCELERATION = 1 };
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param devices Number of devices in order of their priority.
+   * @param arbitration Policy to select among active devices.
+   * @param keyBindings Bindings to apply to the keys of every device.
+   * @param overrideKeys Linux input event codes of the override keys.
+   */
+  InputArbiter(uint32_t devices, Arbitration arbitration, const KeyBindings &keyBindings, const std::vector<uint16_t> &overrideKeys);
+  ~InputArbiter() = default;
+
+  /**
+   * This method applies a key event of a device.
+   *
+   * @param device Index of the device.
+   * @param code Linux input event code.
+   * @param pressed True for a key press.
+   * @param timeStamp CLOCK_MONOTONIC time stamp in microseconds.
+   * @return True if the controlling device or its state changed.
+   */
+  bool onKey(uint32_t device, uint16_t code, bool pressed, int64_t timeStamp) noexcept;
+
+  /**
+   * This method applies an axis position of a device.
+   *
+   * @param device Index of the device.
+   * @param axis Actuation that the axis drives.
+   * @param value Mapped actuation value.
+   * @param isDeflected True if the axis is away from its center.
+   * @param timeStamp CLOCK_MONOTONIC time stamp in microseconds.
+   * @return True if the controlling device or its state changed.
+   */
+  bool onAxis(uint32_t device, Axis axis, float value, bool isDeflected, int64_t timeStamp) noexcept;
+
+  /**
+   * @return State of the controlling device or an idle state if no device is active.
+   */
+  const ActuationState &state() const noexcept;
+
+  /**
+   * @return Index of the controlling device or -1 if no device is active.
+   */
+  int32_t owner() const noexcept;
+
+ private:
+  bool arbitrate(uint32_t device, bool hasStateChanged, int64_t timeStamp) noexcept;
+
+ private:
+  Arbitration m_arbitration;
+  const KeyBindings &m_keyBindings;
+  std::bitset<KEY_CNT> m_overrideKeys{};
+  std::vector<ActuationState> m_states;
+  // Number of held override keys and bits of deflected axes per device.
+  std::vector<uint8_t> m_heldOverrideKeys;
+  std::vector<uint8_t> m_deflectedAxes;
+  // Time stamp when each device became active last.
+  std::vector<int64_t> m_activeSince;
+  uint32_t m_active{0};
+  uint32_t m_overriding{0};
+  int32_t m_owner{-1};
+  ActuationState m_idle{};
+};
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INPUT_BACKEND_HPP
+#define INPUT_BACKEND_HPP
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * Delegate to be called for every key transition. The key code is the Linux
+ * input event code from linux/input-event-codes.h for every backend, the
+ * time stamp is CLOCK_MONOTONIC in microseconds.
+ */
+using KeyDelegate = std::function<void(uint16_t code, bool pressed, int64_t timeStampInMicroseconds)>;
+
+/**
+ * Delegate to be called when an analog axis changed; the value is the raw
+ * position in [-32767, 32767].
+ */
+using AxisDelegate = std::function<void(uint8_t axis, int16_t value, int64_t timeStampInMicroseconds)>;
+
+/**
+ * Interface for a source of key (and axis) events that can be waited for in
+ * an InputEventLoop.
+ */
+class InputBackend {
+ public:
+  virtual ~InputBackend() = default;
+
+  /**
+   * @return True if the backend could open its device.
+   */
+  virtual bool isValid() const noexcept = 0;
+
+  /**
+   * @return File descriptor that becomes readable when events are pending.
+   */
+  virtual int32_t fileDescriptor() const noexcept = 0;
+
+  /**
+   * This method processes all pending events without blocking and calls
+   * the KeyDelegate for every key transition.
+   *
+   * @return false if the device is gone.
+   */
+  virtual bool readEvents() noexcept = 0;
+
+  /**
+   * This method checks that the device still answers, e.g. with a round
+   * trip to the X server. It is called from the input thread's heartbeat
+   * and may block while the device does not answer, so that the input
+   * watchdog trips. Events received meanwhile are left to the following
+   * call of readEvents().
+   *
+   * @return false if the device is gone.
+   */
+  virtual bool probe() noexcept = 0;
+};
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input-event-loop.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+InputEventLoop::InputEventLoop() noexcept {
+  m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+  m_stopFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if ((-1 != m_epollFd) && (-1 != m_stopFd)) {
+    struct epoll_event ev{};
+    ev.events = EPOLLIN;
+    // Tag the stop descriptor with an index that no delegate can have.
+    ev.data.u64 = UINT64_MAX;
+    if (0 != ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_stopFd, &ev)) {
+      ::close(m_stopFd);
+      m_stopFd = -1;
+    }
+  }
+}
+
+InputEventLoop::~InputEventLoop() noexcept {
+  if (-1 != m_stopFd) {
+    ::close(m_stopFd);
+  }
+  if (-1 != m_epollFd) {
+    ::close(m_epollFd);
+  }
+}
+
+bool InputEventLoop::isValid() const noexcept {
+  return (-1 != m_epollFd) && (-1 != m_stopFd);
+}
+
+bool InputEventLoop::add(int32_t fd, std::function<bool()> delegate) noexcept {
+  bool retVal{false};
+  if (isValid() && (0 <= fd) && (nullptr != delegate)) {
+    try {
+      struct epoll_event ev{};
+      ev.events = EPOLLIN;
+      ev.data.u64 = m_delegates.size();
+      m_delegates.push_back(std::move(delegate));
+      retVal = (0 == ::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev));
+      if (!retVal) {
+        m_delegates.pop_back();
+      }
+    } catch (...) {} // LCOV_EXCL_LINE
+  }
+  return retVal;
+}
+
+bool InputEventLoop::run() noexcept {
+  constexpr int32_t MAX_EVENTS{16};
+  struct epoll_event events[MAX_EVENTS];
+  if (!isValid()) {
+    return false;
+  }
+  while (!m_stopped.load()) {
+    const int32_t n = ::epoll_wait(m_epollFd, events, MAX_EVENTS, -1);
+    if (0 > n) {
+      if (EINTR == errno) {
+        continue;
+      }
+      return false;
+    }
+    for (int32_t i{0}; (i < n) && !m_stopped.load(); i++) {
+      const uint64_t index{events[i].data.u64};
+      if (index < m_delegates.size()) {
+        if (!m_delegates[index]()) {
+          m_stopped.store(true);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void InputEventLoop::stop() noexcept {
+  m_stopped.store(true);
+  if (-1 != m_stopFd) {
+    const uint64_t one{1};
+    ssize_t const written = ::write(m_stopFd, &one, sizeof(one));
+    (void)written;
+  }
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INPUT_EVENT_LOOP_HPP
+#define INPUT_EVENT_LOOP_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * This class blocks in epoll on a set of file descriptors and calls the
+ * delegate registered for a descriptor only when it becomes readable.
+ * Thus, the input thread does not wake up while no input is arriving.
+ */
+class InputEventLoop {
+ private:
+  InputEventLoop(const InputEventLoop &) = delete;
+  InputEventLoop(InputEventLoop &&) = delete;
+  InputEventLoop &operator=(const InputEventLoop &) = delete;
+  InputEventLoop &operator=(InputEventLoop &&) = delete;
+
+ public:
+  InputEventLoop() noexcept;
+  ~InputEventLoop() noexcept;
+
+  /**
+   * @return True if the epoll instance could be created.
+   */
+  bool isValid() const noexcept;
+
+  /**
+   * This method registers a file descriptor to wait for.
+   *
+   * @param fd File descriptor to watch for readability.
+   * @param delegate Function to call when fd is readable; returning false ends run().
+   * @return true if the file descriptor could be added.
+   */
+  bool add(int32_t fd, std::function<bool()> delegate) noexcept;
+
+  /**
+   * This method blocks until a delegate returns false or stop() is called.
+   *
+   * @return false if waiting for events failed instead.
+   */
+  bool run() noexcept;
+
+  /**
+   * This method can be called from any thread to make run() return.
+   */
+  void stop() noexcept;
+
+ private:
+  int32_t m_epollFd{-1};
+  int32_t m_stopFd{-1};
+  std::atomic<bool> m_stopped{false};
+  std::vector<std::function<bool()>> m_delegates{};
+};
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input-watchdog.hpp"
+#include "monotonic-time.hpp"
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <cmath>
+
+namespace {
+struct timespec toTimespec(int64_t nanoseconds) noexcept {
+  struct timespec retVal{};
+  retVal.tv_sec = static_cast<time_t>(nanoseconds / (1000 * 1000 * 1000));
+  retVal.tv_nsec = static_cast<long>(nanoseconds % (1000 * 1000 * 1000));
+  return retVal;
+}
+}
+
+InputWatchdog::InputWatchdog(float timeout) noexcept
+    : m_timeout(std::llround(static_cast<double>(timeout) * 1000.0 * 1000.0 * 1000.0)) {
+  if (HEARTBEATS_PER_TIMEOUT <= m_timeout) {
+    m_heartbeatFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    m_timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  }
+  if ((-1 != m_heartbeatFd) && (-1 != m_timerFd)) {
+    struct itimerspec spec{};
+    spec.it_interval = toTimespec(m_timeout / HEARTBEATS_PER_TIMEOUT);
+    spec.it_value = spec.it_interval;
+    if (0 != ::timerfd_settime(m_heartbeatFd, 0, &spec, nullptr)) {
+      ::close(m_heartbeatFd);
+      m_heartbeatFd = -1;
+    }
+    // The timeout starts now as the watched thread might never get to its first heartbeat.
+    heartbeat();
+  }
+}
+
+InputWatchdog::~InputWatchdog() noexcept {
+  if (-1 != m_heartbeatFd) {
+    ::close(m_heartbeatFd);
+  }
+  if (-1 != m_timerFd) {
+    ::close(m_timerFd);
+  }
+}
+
+bool InputWatchdog::isValid() const noexcept {
+  return (-1 != m_heartbeatFd) && (-1 != m_timerFd);
+}
+
+int32_t InputWatchdog::heartbeatFileDescriptor() const noexcept {
+  return m_heartbeatFd;
+}
+
+bool InputWatchdog::onHeartbeatTimer() noexcept {
+  uint64_t expirations{0};
+  ssize_t const bytesRead = ::read(m_heartbeatFd, &expirations, sizeof(expirations));
+  (void)bytesRead;
+  heartbeat();
+  return true;
+}
+
+void InputWatchdog::heartbeat() noexcept {
+  const int64_t now{monotonic::nowInNanoseconds()};
+  m_lastHeartbeat.store(now);
+  struct itimerspec spec{};
+  spec.it_value = toTimespec(now + m_timeout);
+  ::timerfd_settime(m_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+  m_isTripped.store(false);
+}
+
+int32_t InputWatchdog::fileDescriptor() const noexcept {
+  return m_timerFd;
+}
+
+bool InputWatchdog::onTimer() noexcept {
+  uint64_t expirations{0};
+  ssize_t const bytesRead = ::read(m_timerFd, &expirations, sizeof(expirations));
+  (void)bytesRead;
+
+  // A heartbeat might have re-armed the timer after it expired.
+  const int64_t lastHeartbeat{m_lastHeartbeat.load()};
+  bool retVal{false};
+  if ((monotonic::nowInNanoseconds() >= lastHeartbeat + m_timeout) && !m_isTripped.exchange(true)) {
+    if (lastHeartbeat != m_lastHeartbeat.load()) {
+      // The heartbeat came in between.
+      m_isTripped.store(false);
+    } else {
+      m_deadline = lastHeartbeat + m_timeout;
+      m_trips++;
+      retVal = true;
+    }
+  }
+  return retVal;
+}
+
+void InputWatchdog::tripHandled() noexcept {
+  m_tripLatency.record((monotonic::nowInNanoseconds() - m_deadline) / 1000);
+}
+
+bool InputWatchdog::isTripped() const noexcept {
+  return m_isTripped.load();
+}
+
+uint64_t InputWatchdog::trips() const noexcept {
+  return m_trips.load();
+}
+
+const LatencyHistogram &InputWatchdog::tripLatency() const noexcept {
+  return m_tripLatency;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INPUT_WATCHDOG_HPP
+#define INPUT_WATCHDOG_HPP
+
+#include "latency-histogram.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * This class detects a stalled input thread. The input thread handles a
+ * periodic heartbeat timer in its event loop; every heartbeat re-arms a
+ * one-shot timer that expires only if no heartbeat arrives within the
+ * timeout. Both are timerfds, so neither thread polls, and a trip is detected
+ * at the expired deadline instead of at the next send tick.
+ */
+class InputWatchdog {
+ private:
+  InputWatchdog(const InputWatchdog &) = delete;
+  InputWatchdog(InputWatchdog &&) = delete;
+  InputWatchdog &operator=(const InputWatchdog &) = delete;
+  InputWatchdog &operator=(InputWatchdog &&) = delete;
+
+ public:
+  // Heartbeats per timeout; a stall is detected between 3/4 and 4/4 of the timeout after it began.
+  static constexpr int64_t HEARTBEATS_PER_TIMEOUT{4};
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param timeout Maximum age of the last heartbeat in seconds.
+   */
+  explicit InputWatchdog(float timeout) noexcept;
+  ~InputWatchdog() noexcept;
+
+  /**
+   * @return True if both timers could be created.
+   */
+  bool isValid() const noexcept;
+
+  /**
+   * @return Periodic timer to be handled by the watched thread's event loop.
+   */
+  int32_t heartbeatFileDescriptor() const noexcept;
+
+  /**
+   * This method consumes an expiration of the heartbeat timer and calls heartbeat().
+   *
+   * @return True.
+   */
+  bool onHeartbeatTimer() noexcept;
+
+  /**
+   * This method records that the watched thread is alive and clears a trip.
+   */
+  void heartbeat() noexcept;
+
+  /**
+   * @return One-shot timer that becomes readable when the heartbeat is stale.
+   */
+  int32_t fileDescriptor() const noexcept;
+
+  /**
+   * This method consumes an expiration of the one-shot timer.
+   *
+   * @return True if the watchdog has just tripped.
+   */
+  bool onTimer() noexcept;
+
+  /**
+   * This method records the time from the expired deadline until now, i.e.
+   * until the reaction to the trip is done.
+   */
+  void tripHandled() noexcept;
+
+  /**
+   * @return True from a trip until the next heartbeat.
+   */
+  bool isTripped() const noexcept;
+
+  /**
+   * @return Number of trips.
+   */
+  uint64_t trips() const noexcept;
+
+  /**
+   * @return Time from the expired deadline until the trip was handled in microseconds.
+   */
+  const LatencyHistogram &tripLatency() const noexcept;
+
+ private:
+  int64_t m_timeout;
+  int32_t m_heartbeatFd{-1};
+  int32_t m_timerFd{-1};
+  std::atomic<int64_t> m_lastHeartbeat{0};
+  std::atomic<bool> m_isTripped{false};
+  std::atomic<uint64_t> m_trips{0};
+  int64_t m_deadline{0};
+  LatencyHistogram m_tripLatency{};
+};
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "joystick-input-backend.hpp"
+#include "monotonic-time.hpp"
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <linux/joystick.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+JoystickInputBackend::JoystickInputBackend(const std::string &device, KeyDelegate keyDelegate, AxisDelegate axisDelegate) noexcept
+    : m_keyDelegate(std::move(keyDelegate))
+    , m_axisDelegate(std::move(axisDelegate)) {
+  m_fd = ::open(device.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (-1 == m_fd) {
+    std::cerr << "[JoystickInputBackend]: Cannot open " << device << ": " << ::strerror(errno) << std::endl;
+  }
+}
+
+JoystickInputBackend::~JoystickInputBackend() noexcept {
+  if (-1 != m_fd) {
+    ::close(m_fd);
+  }
+}
+
+bool JoystickInputBackend::isValid() const noexcept {
+  return (-1 != m_fd);
+}
+
+int32_t JoystickInputBackend::fileDescriptor() const noexcept {
+  return m_fd;
+}
+
+bool JoystickInputBackend::readEvents() noexcept {
+  // One read per wakeup; if more events are queued, the level-triggered
+  // epoll wakes up again right away.
+  constexpr size_t MAX_EVENTS{64};
+  struct js_event events[MAX_EVENTS];
+  ssize_t bytesRead{0};
+  do {
+    bytesRead = ::read(m_fd, events, sizeof(events));
+  } while ((0 > bytesRead) && (EINTR == errno));
+  if (0 > bytesRead) {
+    // EAGAIN means drained; anything else (e.g. ENODEV) means the device is gone.
+    return (EAGAIN == errno) || (EWOULDBLOCK == errno);
+  }
+  if (0 == bytesRead) {
+    return false;
+  }
+
+  // The driver's time stamps are 32-bit milliseconds on a clock other than
+  // CLOCK_MONOTONIC that wrap after about 49 days; the time of reading is close enough.
+  const int64_t now{monotonic::nowInMicroseconds()};
+  std::bitset<MAX_AXES> changedAxes;
+  const size_t count{static_cast<size_t>(bytesRead) / sizeof(struct js_event)};
+  for (size_t i{0}; i < count; i++) {
+    const struct js_event &ev = events[i];
+    // JS_EVENT_INIT marks the initial state, which is treated like a change.
+    const uint8_t type = ev.type & static_cast<uint8_t>(~JS_EVENT_INIT);
+    if (JS_EVENT_AXIS == type) {
+      changedAxes.set(ev.number, changedAxes.test(ev.number) || (m_axes[ev.number] != ev.value));
+      m_axes[ev.number] = ev.value;
+    } else if ((JS_EVENT_BUTTON == type) && (ev.number < MAX_BUTTONS)) {
+      const bool pressed{0 != ev.value};
+      if (m_pressed[ev.number] != pressed) {
+        m_pressed[ev.number] = pressed;
+        m_keyDelegate(static_cast<uint16_t>(BTN_GAMEPAD + ev.number), pressed, now);
+      }
+    }
+  }
+
+  if (changedAxes.any()) {
+    for (uint32_t axis{0}; axis < MAX_AXES; axis++) {
+      if (changedAxes.test(axis)) {
+        m_axisDelegate(static_cast<uint8_t>(axis), m_axes[axis], now);
+      }
+    }
+  }
+  return true;
+}
+
+bool JoystickInputBackend::probe() noexcept {
+  // Fails with ENODEV once the gamepad is unplugged.
+  uint32_t version{0};
+  return (0 == ::ioctl(m_fd, JSIOCGVERSION, &version));
+}
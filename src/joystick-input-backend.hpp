@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOYSTICK_INPUT_BACKEND_HPP
+#define JOYSTICK_INPUT_BACKEND_HPP
+
+#include "input-backend.hpp"
+
+#include <bitset>
+#include <cstdint>
+#include <string>
+
+/**
+ * This class reads a gamepad from a Linux joystick device (/dev/input/js*).
+ * Buttons are reported as BTN_GAMEPAD + button number (up to 16 buttons),
+ * so that they can be bound like keys. Axis events of one wakeup are
+ * coalesced; the AxisDelegate is called once per changed axis.
+ */
+class JoystickInputBackend : public InputBackend {
+ private:
+  JoystickInputBackend(const JoystickInputBackend &) = delete;
+  JoystickInputBackend(JoystickInputBackend &&) = delete;
+  JoystickInputBackend &operator=(const JoystickInputBackend &) = delete;
+  JoystickInputBackend &operator=(JoystickInputBackend &&) = delete;
+
+ public:
+  static constexpr uint32_t MAX_AXES{256};
+  static constexpr uint32_t MAX_BUTTONS{16};
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param device Joystick device to open.
+   * @param keyDelegate Function to call for every button transition.
+   * @param axisDelegate Function to call for every changed axis.
+   */
+  JoystickInputBackend(const std::string &device, KeyDelegate keyDelegate, AxisDelegate axisDelegate) noexcept;
+  ~JoystickInputBackend() noexcept override;
+
+  bool isValid() const noexcept override;
+  int32_t fileDescriptor() const noexcept override;
+  bool readEvents() noexcept override;
+  bool probe() noexcept override;
+
+ private:
+  KeyDelegate m_keyDelegate{nullptr};
+  AxisDelegate m_axisDelegate{nullptr};
+  int32_t m_fd{-1};
+  int16_t m_axes[MAX_AXES]{};
+  std::bitset<MAX_BUTTONS> m_pressed{};
+};
+
+#endif
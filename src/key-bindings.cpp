@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "key-bindings.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace {
+struct KeyName {
+  const char *name;
+  uint16_t code;
+};
+
+const KeyName keyNames[] = {
+  {"up", KEY_UP}, {"down", KEY_DOWN}, {"left", KEY_LEFT}, {"right", KEY_RIGHT}, {"space", KEY_SPACE},
+  {"a", KEY_A}, {"b", KEY_B}, {"c", KEY_C}, {"d", KEY_D}, {"e", KEY_E}, {"f", KEY_F}, {"g", KEY_G},
+  {"h", KEY_H}, {"i", KEY_I}, {"j", KEY_J}, {"k", KEY_K}, {"l", KEY_L}, {"m", KEY_M}, {"n", KEY_N},
+  {"o", KEY_O}, {"p", KEY_P}, {"q", KEY_Q}, {"r", KEY_R}, {"s", KEY_S}, {"t", KEY_T}, {"u", KEY_U},
+  {"v", KEY_V}, {"w", KEY_W}, {"x", KEY_X}, {"y", KEY_Y}, {"z", KEY_Z},
+  {"0", KEY_0}, {"1", KEY_1}, {"2", KEY_2}, {"3", KEY_3}, {"4", KEY_4},
+  {"5", KEY_5}, {"6", KEY_6}, {"7", KEY_7}, {"8", KEY_8}, {"9", KEY_9},
+};
+
+std::vector<std::string> split(const std::string &str, char delimiter) {
+  std::vector<std::string> retVal;
+  std::stringstream sstr(str);
+  std::string item;
+  while (std::getline(sstr, item, delimiter)) {
+    retVal.push_back(item);
+  }
+  return retVal;
+}
+}
+
+KeyBindings::KeyBindings(const std::string &bindings, const ActuationLimits &limits) noexcept {
+  std::memset(m_bindingOfKey, -1, sizeof(m_bindingOfKey));
+  m_accelerationLow = std::min({limits.accelerationMin, limits.accelerationMax, limits.decelerationMin, limits.decelerationMax});
+  m_accelerationHigh = std::max({limits.accelerationMin, limits.accelerationMax, limits.decelerationMin, limits.decelerationMax});
+  m_steeringLow = std::min(limits.steeringMin, limits.steeringMax);
+  m_steeringHigh = std::max(limits.steeringMin, limits.steeringMax);
+
+  try {
+    m_isValid = true;
+    for (const auto &binding : split(bindings, ',')) {
+      m_isValid &= parse(binding, limits);
+    }
+  } catch (...) {
+    m_isValid = false;
+  }
+}
+
+uint16_t KeyBindings::codeOf(const std::string &name) noexcept {
+  for (const auto &k : keyNames) {
+    if (name == k.name) {
+      return k.code;
+    }
+  }
+  uint16_t retVal{KEY_RESERVED};
+  if (!name.empty() && (5 > name.size()) && (std::string::npos == name.find_first_not_of("0123456789"))) {
+    const int32_t code{std::atoi(name.c_str())};
+    retVal = (code < KEY_CNT) ? static_cast<uint16_t>(code) : KEY_RESERVED;
+  }
+  return retVal;
+}
+
+bool KeyBindings::isValid() const noexcept {
+  return m_isValid;
+}
+
+std::vector<uint16_t> KeyBindings::keys() const noexcept {
+  std::vector<uint16_t> retVal;
+  try {
+    for (const auto &binding : m_bindings) {
+      retVal.push_back(binding.code);
+    }
+  } catch (...) {} // LCOV_EXCL_LINE
+  return retVal;
+}
+
+bool KeyBindings::onKey(uint16_t code, bool pressed, int64_t timeStamp, ActuationState &state) const noexcept {
+  if ((KEY_CNT <= code) || (0 > m_bindingOfKey[code])) {
+    return false;
+  }
+  const uint32_t bit{1u << m_bindingOfKey[code]};
+  if (pressed == (0 != (state.heldBindings & bit))) {
+    // Key repeats do not restart the ramp.
+    return false;
+  }
+  if (pressed) {
+    state.heldBindings |= bit;
+    state.heldSince[m_bindingOfKey[code]] = timeStamp;
+  } else {
+    state.heldBindings &= ~bit;
+  }
+  return true;
+}
+
+void KeyBindings::evaluate(const ActuationState &state, int64_t now, float &acceleration, float &steering) const noexcept {
+  float values[TARGETS]{0.0f, 0.0f, 0.0f, 0.0f};
+  uint32_t held{state.heldBindings};
+  while (0 != held) {
+    const uint32_t i = static_cast<uint32_t>(__builtin_ctz(held));
+    held &= held - 1;
+
+    const Binding &binding{m_bindings[i]};
+    const int64_t step{std::max<int64_t>(0, now - state.heldSince[i]) / binding.stepDuration};
+    const float value{m_ramps[i * RAMP_STEPS + static_cast<uint32_t>(std::min<int64_t>(step, RAMP_STEPS - 1))]};
+    if (std::fabs(value) > std::fabs(values[binding.target])) {
+      values[binding.target] = value;
+    }
+  }
+
+  const uint32_t braking{state.heldBindings & m_decelerationBindings};
+  acceleration = state.acceleration + ((0 != braking) ? values[DECELERATION] : values[ACCELERATION]);
+  steering = state.steering + values[LEFT] + values[RIGHT];
+  acceleration = std::min(std::max(acceleration, m_accelerationLow), m_accelerationHigh);
+  steering = std::min(std::max(steering, m_steeringLow), m_steeringHigh);
+}
+
+bool KeyBindings::parse(const std::string &binding, const ActuationLimits &limits) noexcept {
+  try {
+    const auto fields = split(binding, ':');
+    if ((2 > fields.size()) || (4 < fields.size()) || (ActuationState::MAX_HELD_BINDINGS <= m_bindings.size())) {
+      std::cerr << "[KeyBindings]: Cannot use binding '" << binding << "'." << std::endl;
+      return false;
+    }
+
+    const uint16_t code{codeOf(fields[0])};
+    if ((KEY_RESERVED == code) || (KEY_ESC == code) || (0 <= m_bindingOfKey[code])) {
+      std::cerr << "[KeyBindings]: Cannot bind key '" << fields[0] << "'." << std::endl;
+      return false;
+    }
+
+    Target target;
+    float from;
+    float to;
+    if ("acc" == fields[1]) {
+      target = ACCELERATION;
+      from = limits.accelerationMin;
+      to = limits.accelerationMax;
+    } else if ("dec" == fields[1]) {
+      target = DECELERATION;
+      from = limits.decelerationMin;
+      to = limits.decelerationMax;
+    } else if ("left" == fields[1]) {
+      target = LEFT;
+      from = 0.0f;
+      to = limits.steeringMax;
+    } else if ("right" == fields[1]) {
+      target = RIGHT;
+      from = 0.0f;
+      to = limits.steeringMin;
+    } else {
+      std::cerr << "[KeyBindings]: Unknown target '" << fields[1] << "'." << std::endl;
+      return false;
+    }
+
+    const float RAMP_TIME{(2 < fields.size()) ? std::stof(fields[2]) : 0.0f};
+    const float EXPONENT{(3 < fields.size()) ? std::stof(fields[3]) : 1.0f};
+    if ((0.0f > RAMP_TIME) || (0.0f >= EXPONENT)) {
+      std::cerr << "[KeyBindings]: Invalid ramp in '" << binding << "'." << std::endl;
+      return false;
+    }
+
+    // Entry i holds the value after i steps of hold time; the last one is reached at RAMP_TIME.
+    const int64_t STEP_DURATION{std::max<int64_t>(1, std::llround(RAMP_TIME * 1000.0f * 1000.0f / static_cast<float>(RAMP_STEPS - 1)))};
+    for (uint32_t i{0}; i < RAMP_STEPS; i++) {
+      const float t{(0.0f < RAMP_TIME) ? static_cast<float>(i) / static_cast<float>(RAMP_STEPS - 1) : 1.0f};
+      m_ramps.push_back(from + (to - from) * std::pow(t, EXPONENT));
+    }
+    if (DECELERATION == target) {
+      m_decelerationBindings |= 1u << m_bindings.size();
+    }
+    m_bindingOfKey[code] = static_cast<int8_t>(m_bindings.size());
+    m_bindings.push_back(Binding{code, target, STEP_DURATION});
+  } catch (...) {
+    std::cerr << "[KeyBindings]: Cannot parse binding '" << binding << "'." << std::endl;
+    return false;
+  }
+  return true;
+}
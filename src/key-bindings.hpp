@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEY_BINDINGS_HPP
+#define KEY_BINDINGS_HPP
+
+#include "actuation-state.hpp"
+
+#include <linux/input.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Limits of the actuation as given on the command line.
+ */
+struct ActuationLimits {
+  float accelerationMin{0.0f};
+  float accelerationMax{0.0f};
+  float decelerationMin{0.0f};
+  float decelerationMax{0.0f};
+  float steeringMin{0.0f};
+  float steeringMax{0.0f};
+};
+
+/**
+ * This class maps held keys to acceleration, braking, and steering. Each
+ * binding ramps its value from the *_min to the *_max limit (steering from
+ * 0) over a hold time along the curve t^exponent.
+ *
+ * The bindings are given as a comma-separated list of
+ *     <key>:<acc|dec|left|right>[:<ramp time in s>[:<exponent>]]
+ * where <key> is a letter, a digit, up, down, left, right, space, or a Linux
+ * input event code. All curves are sampled into flat tables at construction;
+ * afterwards, key events and evaluation only do table reads and bit tests.
+ */
+class KeyBindings {
+ private:
+  KeyBindings(const KeyBindings &) = delete;
+  KeyBindings(KeyBindings &&) = delete;
+  KeyBindings &operator=(const KeyBindings &) = delete;
+  KeyBindings &operator=(KeyBindings &&) = delete;
+
+ public:
+  static constexpr const char *DEFAULT{"up:acc:1,w:acc:1,down:dec:0.5,s:dec:0.5,left:left:0.5,a:left:0.5,right:right:0.5,d:right:0.5"};
+  static constexpr uint32_t RAMP_STEPS{64};
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param bindings Bindings as described above.
+   * @param limits Limits to ramp between.
+   */
+  KeyBindings(const std::string &bindings, const ActuationLimits &limits) noexcept;
+  ~KeyBindings() = default;
+
+  /**
+   * @param name Key name as in the bindings.
+   * @return Linux input event code of the key or KEY_RESERVED if unknown.
+   */
+  static uint16_t codeOf(const std::string &name) noexcept;
+
+  /**
+   * @return True if all bindings could be parsed.
+   */
+  bool isValid() const noexcept;
+
+  /**
+   * @return Linux input event codes of all bound keys.
+   */
+  std::vector<uint16_t> keys() const noexcept;
+
+  /**
+   * This method records a key event in the given state.
+   *
+   * @param code Linux input event code.
+   * @param pressed True for a key press.
+   * @param timeStamp CLOCK_MONOTONIC time stamp of the event in microseconds.
+   * @param state State to update.
+   * @return True if the key is bound and its state changed.
+   */
+  bool onKey(uint16_t code, bool pressed, int64_t timeStamp, ActuationState &state) const noexcept;
+
+  /**
+   * This method adds the contribution of all held keys to the acceleration
+   * and steering of the given state and saturates them to the limits. Of
+   * several held keys with the same target, the largest value counts; a held
+   * brake key overrides the acceleration keys.
+   *
+   * @param state State with the held keys.
+   * @param now CLOCK_MONOTONIC time in microseconds to evaluate the ramps at.
+   * @param acceleration Resulting acceleration.
+   * @param steering Resulting steering.
+   */
+  void evaluate(const ActuationState &state, int64_t now, float &acceleration, float &steering) const noexcept;
+
+ private:
+  enum Target : uint8_t { ACCELERATION = 0, DECELERATION = 1, LEFT = 2, RIGHT = 3, TARGETS = 4 };
+
+  struct Binding {
+    uint16_t code;
+    Target target;
+    // Hold time in microseconds per entry of the ramp table.
+    int64_t stepDuration;
+  };
+
+  bool parse(const std::string &binding, const ActuationLimits &limits) noexcept;
+
+ private:
+  bool m_isValid{false};
+  std::vector<Binding> m_bindings{};
+  // RAMP_STEPS samples per binding, stored back to back.
+  std::vector<float> m_ramps{};
+  // Index of the binding per Linux input event code; -1 if the key is unbound.
+  int8_t m_bindingOfKey[KEY_CNT]{};
+  // Bits of the bindings that brake.
+  uint32_t m_decelerationBindings{0};
+  float m_accelerationLow{0.0f};
+  float m_accelerationHigh{0.0f};
+  float m_steeringLow{0.0f};
+  float m_steeringHigh{0.0f};
+};
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "latency-histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+LatencyHistogram::LatencyHistogram() noexcept {
+  reset();
+}
+
+uint32_t LatencyHistogram::indexOf(uint64_t value) noexcept {
+  if (value < LINEAR) {
+    return static_cast<uint32_t>(value);
+  }
+  // The position of the highest bit selects the octave, the next bits the bucket therein.
+  const uint32_t msb{63u - static_cast<uint32_t>(__builtin_clzll(value))};
+  const uint32_t shift{msb - (LINEAR_BITS - 1)};
+  const uint32_t subBucket{static_cast<uint32_t>(value >> shift) - HALF};
+  return LINEAR + (msb - LINEAR_BITS) * HALF + subBucket;
+}
+
+uint64_t LatencyHistogram::highestValueOf(uint32_t index) noexcept {
+  if (index < LINEAR) {
+    return index;
+  }
+  const uint32_t octave{(index - LINEAR) / HALF};
+  const uint32_t subBucket{(index - LINEAR) % HALF};
+  const uint32_t shift{octave + 1};
+  return ((static_cast<uint64_t>(HALF + subBucket) + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(int64_t value) noexcept {
+  const uint64_t v{(0 < value) ? static_cast<uint64_t>(value) : 0};
+  m_buckets[indexOf(v)].fetch_add(1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+
+  int64_t currentMax{m_max.load(std::memory_order_relaxed)};
+  while ((static_cast<int64_t>(v) > currentMax) && !m_max.compare_exchange_weak(currentMax, static_cast<int64_t>(v), std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() noexcept {
+  for (auto &bucket : m_buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  m_count.store(0, std::memory_order_relaxed);
+  m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const noexcept {
+  return m_count.load(std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::valueAtPercentile(double percentile) const noexcept {
+  const uint64_t total{count()};
+  if (0 == total) {
+    return 0;
+  }
+  const double clamped{std::min(100.0, std::max(0.0, percentile))};
+  const uint64_t rank{std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total))))};
+
+  uint64_t seen{0};
+  for (uint32_t i{0}; i < BUCKETS; i++) {
+    seen += m_buckets[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      return std::min(static_cast<int64_t>(highestValueOf(i)), max());
+    }
+  }
+  return max();
+}
+
+int64_t LatencyHistogram::max() const noexcept {
+  return m_max.load(std::memory_order_relaxed);
+}
+
+std::string LatencyHistogram::summary(const std::string &unit) const noexcept {
+  std::stringstream sstr;
+  sstr << "count = " << count()
+       << ", p50 = " << valueAtPercentile(50.0) << unit
+       << ", p90 = " << valueAtPercentile(90.0) << unit
+       << ", p99 = " << valueAtPercentile(99.0) << unit
+       << ", p99.9 = " << valueAtPercentile(99.9) << unit
+       << ", max = " << max() << unit;
+  return sstr.str();
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * Histogram with log-linear buckets in the style of HdrHistogram: values
+ * below 64 are counted exactly, larger ones with 32 buckets per power of
+ * two (i.e. at most ~3% relative error). Recording is a single relaxed
+ * atomic increment without any allocation, so it can be read from another
+ * thread at any time.
+ */
+class LatencyHistogram {
+ private:
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram(LatencyHistogram &&) = delete;
+  LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+  LatencyHistogram &operator=(LatencyHistogram &&) = delete;
+
+ public:
+  LatencyHistogram() noexcept;
+
+  /**
+   * This method records one value; negative values are counted as 0.
+   *
+   * @param value Value to record.
+   */
+  void record(int64_t value) noexcept;
+
+  /**
+   * This method resets all buckets.
+   */
+  void reset() noexcept;
+
+  /**
+   * @return Number of recorded values.
+   */
+  uint64_t count() const noexcept;
+
+  /**
+   * @param percentile Percentile in [0 .. 100].
+   * @return Highest value equivalent to the given percentile.
+   */
+  int64_t valueAtPercentile(double percentile) const noexcept;
+
+  /**
+   * @return Largest recorded value.
+   */
+  int64_t max() const noexcept;
+
+  /**
+   * @param unit Unit to append to the values.
+   * @return One line with count, p50, p90, p99, p99.9, and max.
+   */
+  std::string summary(const std::string &unit) const noexcept;
+
+ private:
+  static constexpr uint32_t LINEAR_BITS{6};
+  static constexpr uint32_t LINEAR{1u << LINEAR_BITS};
+  static constexpr uint32_t HALF{LINEAR / 2};
+  static constexpr uint32_t BUCKETS{LINEAR + (64 - LINEAR_BITS) * HALF};
+
+  static uint32_t indexOf(uint64_t value) noexcept;
+  static uint64_t highestValueOf(uint32_t index) noexcept;
+
+ private:
+  std::atomic<uint64_t> m_buckets[BUCKETS];
+  std::atomic<uint64_t> m_count{0};
+  std::atomic<int64_t> m_max{0};
+};
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MONOTONIC_TIME_HPP
+#define MONOTONIC_TIME_HPP
+
+#include <ctime>
+#include <cstdint>
+
+namespace monotonic {
+
+/**
+ * @return Current CLOCK_MONOTONIC time in microseconds; unlike
+ *         cluon::time::now(), it is not affected by NTP steps.
+ */
+inline int64_t nowInMicroseconds() noexcept {
+  struct timespec ts{};
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000 * 1000 + static_cast<int64_t>(ts.tv_nsec) / 1000;
+}
+
+/**
+ * @return Current CLOCK_MONOTONIC time in nanoseconds.
+ */
+inline int64_t nowInNanoseconds() noexcept {
+  struct timespec ts{};
+  ::clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000 * 1000 * 1000 + static_cast<int64_t>(ts.tv_nsec);
+}
+
+/**
+ * @param serverTime An X event's server time in milliseconds.
+ * @param now Time of reading the event in microseconds.
+ * @return The event's CLOCK_MONOTONIC time in microseconds. On Linux, the
+ *         X server's time is CLOCK_MONOTONIC in milliseconds wrapped to 32
+ *         bits; anything implausible falls back to the time of reading.
+ */
+inline int64_t fromXServerTime(uint64_t serverTime, int64_t now) noexcept {
+  const uint32_t nowInMilliseconds{static_cast<uint32_t>(now / 1000)};
+  const uint32_t age{nowInMilliseconds - static_cast<uint32_t>(serverTime)};
+  return (age < 10 * 1000) ? now - static_cast<int64_t>(age) * 1000 : now;
+}
+
+} // namespace monotonic
+
+#endif
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cluon-complete.hpp"
+#include "actuationrequestmessage.hpp"
+#include "latency-histogram.hpp"
+#include "monotonic-time.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+// Linux' error numbers are all below this; larger ones share the last counter.
+constexpr int32_t MAX_ERRNO{256};
+
+struct Statistics {
+  uint64_t sent{0};
+  uint64_t bytes{0};
+  // Number of failed sends per errno.
+  std::array<uint64_t, MAX_ERRNO> errors{};
+  // Time from a message's deadline until it was handed to the socket.
+  LatencyHistogram lateness{};
+};
+
+std::string encode(int32_t dataType, const std::string &serializedData, uint32_t senderStamp) noexcept {
+  cluon::data::Envelope envelope;
+  envelope.dataType(dataType).serializedData(serializedData).sent(cluon::time::now()).senderStamp(senderStamp);
+  envelope.sampleTimeStamp(envelope.sent());
+  return cluon::serializeEnvelope(std::move(envelope));
+}
+
+void sleepUntil(int64_t deadlineInNanoseconds) noexcept {
+  struct timespec ts{};
+  ts.tv_sec = static_cast<time_t>(deadlineInNanoseconds / (1000 * 1000 * 1000));
+  ts.tv_nsec = static_cast<long>(deadlineInNanoseconds % (1000 * 1000 * 1000));
+  while (EINTR == ::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr)) {}
+}
+}
+
+int32_t main(int32_t argc, char **argv) {
+  auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
+  if ((0 == commandlineArguments.count("cid")) || (0 == commandlineArguments.count("rate"))) {
+    std::cerr << argv[0] << " floods an OD4Session with ActuationRequests or envelopes of arbitrary size at a paced rate to find the limits of its receivers." << std::endl;
+    std::cerr << "Usage:   " << argv[0] << " --cid=<OpenDaVINCI session> --rate=<messages per second and thread> [--threads=1] [--sender_stamps=1] [--payload=<bytes>] [--data_type=<message identifier>] [--duration=<seconds>] [--fresh_timestamps]" << std::endl;
+    std::cerr << "Example: " << argv[0] << " --cid=111 --rate=10000 --threads=4 --sender_stamps=2" << std::endl;
+    std::cerr << "         Thread t sends with the senderStamps t * sender_stamps .. (t + 1) * sender_stamps - 1 in turn. Without --payload, the envelopes carry ActuationRequests;"
+              << " all envelopes are encoded up front, so their sent time stamps are the start time unless --fresh_timestamps encodes every envelope when it is sent." << std::endl;
+    return 1;
+  }
+  const uint16_t CID{static_cast<uint16_t>(std::stoi(commandlineArguments["cid"]))};
+  const double RATE{std::stod(commandlineArguments["rate"])};
+  const uint32_t THREADS{(commandlineArguments.count("threads") != 0) ? static_cast<uint32_t>(std::stoul(commandlineArguments["threads"])) : 1};
+  const uint32_t SENDER_STAMPS{(commandlineArguments.count("sender_stamps") != 0) ? static_cast<uint32_t>(std::stoul(commandlineArguments["sender_stamps"])) : 1};
+  const bool HAS_PAYLOAD{commandlineArguments.count("payload") != 0};
+  const size_t PAYLOAD{HAS_PAYLOAD ? static_cast<size_t>(std::stoul(commandlineArguments["payload"])) : 0};
+  const int32_t DATA_TYPE{(commandlineArguments.count("data_type") != 0) ? std::stoi(commandlineArguments["data_type"]) : (HAS_PAYLOAD ? 0 : static_cast<int32_t>(opendlv::proxy::ActuationRequest::ID()))};
+  const double DURATION{(commandlineArguments.count("duration") != 0) ? std::stod(commandlineArguments["duration"]) : 10.0};
+  const bool FRESH_TIMESTAMPS{commandlineArguments.count("fresh_timestamps") != 0};
+  if ((0.0 >= RATE) || (0 == THREADS) || (0 == SENDER_STAMPS) || (0.0 >= DURATION)) {
+    std::cerr << "Rate, threads, sender_stamps, and duration must be positive." << std::endl;
+    return 1;
+  }
+
+  std::string serializedData(PAYLOAD, 'x');
+  if (!HAS_PAYLOAD) {
+    opendlv::proxy::ActuationRequest ar;
+    ar.acceleration(0.0f).steering(0.0f).isValid(false);
+    cluon::ToProtoVisitor protoEncoder;
+    ar.accept(protoEncoder);
+    serializedData = protoEncoder.encodedData();
+  }
+
+  const uint64_t MESSAGES{static_cast<uint64_t>(DURATION * RATE)};
+  std::vector<std::unique_ptr<Statistics>> statistics;
+  std::vector<std::thread> threads;
+  const int64_t START{monotonic::nowInNanoseconds() + 100 * 1000 * 1000};
+  // Computed from the start for every message, so that rates whose period is
+  // no whole number of nanoseconds do not drift.
+  auto deadline = [&START, &RATE](uint64_t i) {
+    return START + static_cast<int64_t>(static_cast<double>(i) * 1e9 / RATE);
+  };
+  for (uint32_t t{0}; t < THREADS; t++) {
+    statistics.push_back(std::make_unique<Statistics>());
+    Statistics *stats{statistics.back().get()};
+    threads.emplace_back([&, t, stats]() {
+      // Every thread has its own socket, so that they do not contend for its mutex.
+      cluon::UDPSender sender{"225.0.0." + std::to_string(CID), 12175};
+      std::vector<std::string> envelopes;
+      size_t largestEnvelope{0};
+      for (uint32_t s{0}; s < SENDER_STAMPS; s++) {
+        envelopes.push_back(encode(DATA_TYPE, serializedData, t * SENDER_STAMPS + s));
+        largestEnvelope = std::max(largestEnvelope, envelopes.back().size());
+      }
+      // UDPSender::send takes its data by rvalue; the encoded envelopes are
+      // copied into this buffer, which never reallocates as it is reserved up front.
+      std::string buffer;
+      buffer.reserve(largestEnvelope);
+
+      // Messages that are due are sent back to back, so that the rate is kept also below the sleep granularity.
+      uint64_t i{0};
+      while (i < MESSAGES) {
+        sleepUntil(deadline(i));
+        const int64_t now{monotonic::nowInNanoseconds()};
+        for (; (i < MESSAGES) && (deadline(i) <= now); i++) {
+          const uint32_t s{static_cast<uint32_t>(i % SENDER_STAMPS)};
+          if (FRESH_TIMESTAMPS) {
+            envelopes[s] = encode(DATA_TYPE, serializedData, t * SENDER_STAMPS + s);
+          }
+          buffer.assign(envelopes[s]);
+          // Oversized envelopes fail with E2BIG and a closed socket with EBADF, as for every other sender.
+          auto result = sender.send(std::move(buffer));
+          if (0 > result.first) {
+            stats->errors[static_cast<size_t>(std::min(std::max(result.second, 0), MAX_ERRNO - 1))]++;
+          } else {
+            stats->sent++;
+            stats->bytes += envelopes[s].size();
+          }
+          stats->lateness.record(monotonic::nowInNanoseconds() - deadline(i));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  const double ELAPSED{static_cast<double>(monotonic::nowInNanoseconds() - START) / 1e9};
+
+  uint64_t sent{0};
+  uint64_t bytes{0};
+  std::array<uint64_t, MAX_ERRNO> errors{};
+  for (uint32_t t{0}; t < THREADS; t++) {
+    const Statistics &stats{*statistics[t]};
+    std::cout << "thread " << t << ": sent " << stats.sent << " of " << MESSAGES << ", lateness: " << stats.lateness.summary(" ns") << std::endl;
+    sent += stats.sent;
+    bytes += stats.bytes;
+    for (size_t e{0}; e < errors.size(); e++) {
+      errors[e] += stats.errors[e];
+    }
+  }
+  std::cout << std::fixed << std::setprecision(1) << "sent " << sent << " envelopes (" << (bytes / std::max<uint64_t>(1, sent)) << " bytes each) in "
+            << ELAPSED << " s: " << static_cast<double>(sent) / ELAPSED << " envelopes/s of " << RATE * THREADS << " requested, "
+            << static_cast<double>(bytes) * 8.0 / ELAPSED / 1e6 << " Mbit/s" << std::endl;
+  bool hasErrors{false};
+  for (size_t e{0}; e < errors.size(); e++) {
+    if (0 < errors[e]) {
+      std::cout << "send error " << ::strerror(static_cast<int32_t>(e)) << ": " << errors[e] << std::endl;
+      hasErrors = true;
+    }
+  }
+  return hasErrors ? 1 : 0;
+}
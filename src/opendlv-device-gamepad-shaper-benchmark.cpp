@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cluon-complete.hpp"
+#include "control-shaper.hpp"
+#include "deadline-scheduler.hpp"
+#include "latency-histogram.hpp"
+#include "monotonic-time.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+int32_t main(int32_t argc, char **argv) {
+  auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
+  const float DURATION{(commandlineArguments.count("duration") != 0) ? std::stof(commandlineArguments["duration"]) : 1.0f};
+  if (0.0f >= DURATION) {
+    std::cerr << argv[0] << " measures the per-tick cost of each ActuationRequest filter and of the full chain." << std::endl;
+    std::cerr << "Usage:   " << argv[0] << " [--duration=<seconds per run>]" << std::endl;
+    return 1;
+  }
+
+  struct Run {
+    const char *name;
+    ShapingConfig config;
+  };
+  const Run runs[] = {
+    {"deadband", ShapingConfig{0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}},
+    {"smoothing", ShapingConfig{0.0f, 0.05f, 0.0f, 0.0f, 0.0f, 0.0f}},
+    {"rate limit", ShapingConfig{0.0f, 0.0f, 5.0f, 0.0f, 0.0f, 0.0f}},
+    {"jerk limit", ShapingConfig{0.0f, 0.0f, 0.0f, 50.0f, 0.0f, 0.0f}},
+    {"saturation", ShapingConfig{0.0f, 0.0f, 0.0f, 0.0f, -10.0f, 10.0f}},
+    {"full chain", ShapingConfig{0.5f, 0.05f, 5.0f, 50.0f, -10.0f, 10.0f}},
+  };
+
+  std::cout << std::left << std::setw(12) << "filter" << std::setw(8) << "rate"
+            << "cost per tick of both channels (incl. ~20 ns timing overhead)" << std::endl;
+  for (const float FREQ : {1000.0f, 10000.0f}) {
+    for (const auto &run : runs) {
+      ControlShaper shaper{run.config, run.config};
+      LatencyHistogram cost;
+      int64_t totalCost{0};
+      uint64_t ticks{0};
+      // Keep the compiler from dropping the filtered values.
+      volatile float sink{0.0f};
+
+      DeadlineScheduler scheduler;
+      const uint64_t TICKS{static_cast<uint64_t>(DURATION * FREQ)};
+      const int32_t trigger = scheduler.add(FREQ, CatchUpPolicy::SKIP, [&FREQ, &TICKS, &shaper, &cost, &totalCost, &ticks, &sink]() {
+        // A square wave with noise exercises every stage.
+        const float t{static_cast<float>(ticks) / FREQ};
+        float acceleration{((0 == (ticks / static_cast<uint64_t>(FREQ / 4.0f)) % 2) ? 8.0f : -8.0f) + 0.3f * std::sin(977.0f * t)};
+        float steering{12.0f * std::sin(6.0f * t)};
+
+        const int64_t before{monotonic::nowInNanoseconds()};
+        shaper.apply(1.0f / FREQ, acceleration, steering);
+        const int64_t duration{monotonic::nowInNanoseconds() - before};
+
+        sink = acceleration + steering;
+        cost.record(duration);
+        totalCost += duration;
+        return ++ticks < TICKS;
+      });
+      if (-1 == trigger) {
+        std::cerr << "Cannot create the timer." << std::endl;
+        return 1;
+      }
+      scheduler.run();
+      (void)sink;
+
+      const double mean{static_cast<double>(totalCost) / static_cast<double>(std::max<uint64_t>(1, ticks))};
+      std::cout << std::left << std::setw(12) << run.name << std::setw(8) << (std::to_string(static_cast<int32_t>(FREQ / 1000.0f)) + " kHz")
+                << "mean = " << std::fixed << std::setprecision(1) << mean << " ns, " << cost.summary(" ns")
+                << ", CPU = " << std::setprecision(4) << mean * static_cast<double>(FREQ) / 1e7 << " %, missed = "
+                << scheduler.statistics(trigger)->missedTicks.load() << std::endl;
+    }
+  }
+  return 0;
+}
@@ -17,6 +17,7 @@
 
 #include "cluon-complete.hpp"
 #include "actuationrequestmessage.hpp"
+#include "latency-histogram.hpp"
 
 #include <linux/joystick.h>
 #include <fcntl.h>
@@ -28,11 +29,36 @@
 #include <cerrno>
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 
+namespace {
+/**
+ * Aggregates of the ActuationRequests of one senderStamp; all times are in
+ * microseconds.
+ */
+struct Stream {
+  int64_t lastSent{0};
+  int64_t lastReceived{0};
+  // Expected time between two ActuationRequests.
+  int64_t period{0};
+  uint64_t total{0};
+  uint64_t received{0};
+  uint64_t gaps{0};
+  uint64_t lost{0};
+  // Interarrival jitter like RFC 3550: smoothed deviation of the receive spacing from the send spacing.
+  double jitter{0.0};
+  LatencyHistogram interArrival{};
+  LatencyHistogram latency{};
+};
+}
+
 int32_t main(int32_t argc, char **argv) {
   int32_t retCode{0};
   auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
@@ -40,22 +66,84 @@ int32_t main(int32_t argc, char **argv) {
     std::cerr << argv[0]
               << " interfaces with the given PS3 controller to emit ActuationRequest messages to an OD4Session."
               << std::endl;
-    std::cerr << "Usage:   " << argv[0] << " --cid=<OpenDaVINCI session> [--verbose]" << std::endl;
+    std::cerr << "Usage:   " << argv[0] << " --cid=<OpenDaVINCI session> [--analyze [--interval=<seconds>] [--freq=<expected frequency in Hz>]] [--verbose]" << std::endl;
     std::cerr << "Example: " << argv[0] << " --cid=111" << std::endl;
+    std::cerr << "         --analyze prints the send rate, gaps and losses, inter-arrival jitter, and sent-to-received latency per senderStamp every --interval instead of every ActuationRequest;"
+              << " gaps are times between two sent time stamps above 1.5 periods of --freq (default: the median inter-arrival time of the previous interval), including ticks that the sender missed."
+              << std::endl;
     retCode = 1;
   } else {
+    const bool ANALYZE{commandlineArguments.count("analyze") != 0};
+    const float INTERVAL{(commandlineArguments.count("interval") != 0) ? std::stof(commandlineArguments["interval"]) : 1.0f};
+    const float FREQ{(commandlineArguments.count("freq") != 0) ? std::stof(commandlineArguments["freq"]) : 0.0f};
+
     cluon::OD4Session od4{static_cast<uint16_t>(std::stoi(commandlineArguments["cid"]))};
 
     if (od4.isRunning()) {
-      auto onActuationRequest = [](cluon::data::Envelope &&env) {
-        // Now, we unpack the cluon::data::Envelope to get our message.
-        auto msg = cluon::extractMessage<opendlv::proxy::ActuationRequest>(std::move(env));
-        std::cout << "acceleration = " << msg.acceleration() << ", steering = " << msg.steering() << std::endl;
+      // Streams are only created for new senderStamps; everything else is fixed-size.
+      std::mutex streamsMutex;
+      std::map<uint32_t, std::unique_ptr<Stream>> streams;
+
+      auto onActuationRequest = [&ANALYZE, &FREQ, &streamsMutex, &streams](cluon::data::Envelope &&env) {
+        if (!ANALYZE) {
+          // Now, we unpack the cluon::data::Envelope to get our message.
+          auto msg = cluon::extractMessage<opendlv::proxy::ActuationRequest>(std::move(env));
+          std::cout << "acceleration = " << msg.acceleration() << ", steering = " << msg.steering() << std::endl;
+          return;
+        }
+
+        // Both time stamps are wall-clock times; across hosts, their latency includes the clock offset.
+        const int64_t sent{cluon::time::toMicroseconds(env.sent())};
+        const int64_t received{cluon::time::toMicroseconds(env.received())};
+        std::lock_guard<std::mutex> lck(streamsMutex);
+        auto &stream = streams[env.senderStamp()];
+        if (nullptr == stream) {
+          stream = std::make_unique<Stream>();
+          stream->period = (0.0f < FREQ) ? static_cast<int64_t>(1000.0f * 1000.0f / FREQ) : 0;
+        }
+        stream->latency.record(received - sent);
+        if (0 != stream->total) {
+          const int64_t interArrival{received - stream->lastReceived};
+          stream->interArrival.record(interArrival);
+          const int64_t sentInterval{sent - stream->lastSent};
+          const double deviation{static_cast<double>(std::llabs(interArrival - sentInterval))};
+          stream->jitter += (deviation - stream->jitter) / 16.0;
+
+          // Delays in the network do not move the sent time stamps; thus, a gap there is a lost or unsent ActuationRequest.
+          const int64_t period{stream->period};
+          if ((0 < period) && (sentInterval > period + period / 2)) {
+            stream->gaps++;
+            stream->lost += static_cast<uint64_t>((sentInterval + period / 2) / period - 1);
+          }
+        }
+        stream->lastSent = sent;
+        stream->lastReceived = received;
+        stream->total++;
+        stream->received++;
       };
       od4.dataTrigger(opendlv::proxy::ActuationRequest::ID(), onActuationRequest);
       while (1) {
-        using namespace std::chrono_literals;
-        std::this_thread::sleep_for(1s);
+        std::this_thread::sleep_for(ANALYZE ? std::chrono::duration<float>(INTERVAL) : std::chrono::duration<float>(1.0f));
+        if (ANALYZE) {
+          std::lock_guard<std::mutex> lck(streamsMutex);
+          for (auto &entry : streams) {
+            Stream &stream{*entry.second};
+            std::cout << "senderStamp = " << entry.first << ": " << stream.received << " received (" << std::fixed << std::setprecision(1)
+                      << static_cast<float>(stream.received) / INTERVAL << "/s), " << stream.gaps << " gaps, " << stream.lost << " lost, jitter = "
+                      << stream.jitter << " us" << std::endl
+                      << "  inter-arrival: " << stream.interArrival.summary(" us") << std::endl
+                      << "  sent-to-received: " << stream.latency.summary(" us") << std::endl;
+            // Every interval is summarized on its own; jitter and the last time stamps carry over.
+            if ((0.0f >= FREQ) && (0 < stream.interArrival.count())) {
+              stream.period = stream.interArrival.valueAtPercentile(50.0);
+            }
+            stream.received = 0;
+            stream.gaps = 0;
+            stream.lost = 0;
+            stream.interArrival.reset();
+            stream.latency.reset();
+          }
+        }
       }
       retCode = 0;
     }
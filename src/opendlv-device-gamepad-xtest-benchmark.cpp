@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cluon-complete.hpp"
+#include "actuationrequestmessage.hpp"
+#include "latency-histogram.hpp"
+#include "monotonic-time.hpp"
+
+#include <X11/Xlib.h>
+#include <X11/keysym.h>
+#include <X11/extensions/XTest.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+// Starts a program with the given arguments and DISPLAY; returns its pid or -1.
+pid_t spawn(const std::vector<std::string> &arguments, const std::string &display) noexcept {
+  std::vector<char *> argv;
+  for (const auto &argument : arguments) {
+    argv.push_back(const_cast<char *>(argument.c_str()));
+  }
+  argv.push_back(nullptr);
+  const pid_t pid{::fork()};
+  if (0 == pid) {
+    ::setenv("DISPLAY", display.c_str(), 1);
+    ::execvp(argv[0], argv.data());
+    ::_exit(127);
+  }
+  return pid;
+}
+
+void terminate(pid_t pid, int signal) noexcept {
+  if (0 < pid) {
+    ::kill(pid, signal);
+    int status{0};
+    ::waitpid(pid, &status, 0);
+  }
+}
+
+// User and system CPU time of a process in seconds from /proc/<pid>/stat.
+double cpuTime(pid_t pid) noexcept {
+  double retVal{0.0};
+  try {
+    std::ifstream in("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat;
+    std::getline(in, stat);
+    // The command name in parentheses may contain spaces; fields 14 and 15 follow it.
+    std::stringstream sstr(stat.substr(stat.rfind(')') + 2));
+    std::string field;
+    uint64_t utime{0};
+    uint64_t stime{0};
+    for (uint32_t i{3}; (i < 14) && (sstr >> field); i++) {}
+    sstr >> utime >> stime;
+    retVal = static_cast<double>(utime + stime) / static_cast<double>(::sysconf(_SC_CLK_TCK));
+  } catch (...) {} // LCOV_EXCL_LINE
+  return retVal;
+}
+
+void sleepUntil(int64_t deadlineInNanoseconds) noexcept {
+  struct timespec ts{};
+  ts.tv_sec = static_cast<time_t>(deadlineInNanoseconds / (1000 * 1000 * 1000));
+  ts.tv_nsec = static_cast<long>(deadlineInNanoseconds % (1000 * 1000 * 1000));
+  while (EINTR == ::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr)) {}
+}
+}
+
+int32_t main(int32_t argc, char **argv) {
+  auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
+  const std::string SELF{argv[0]};
+  const std::string GAMEPAD{(commandlineArguments.count("gamepad") != 0) ? commandlineArguments["gamepad"]
+      : SELF.substr(0, SELF.rfind("-xtest-benchmark"))};
+  const std::string DISPLAY{(commandlineArguments.count("display") != 0) ? commandlineArguments["display"] : ":99"};
+  const uint16_t CID{static_cast<uint16_t>((commandlineArguments.count("cid") != 0) ? std::stoi(commandlineArguments["cid"]) : 199)};
+  const std::string FREQ{(commandlineArguments.count("freq") != 0) ? commandlineArguments["freq"] : "100"};
+  const std::string BACKEND{(commandlineArguments.count("backend") != 0) ? commandlineArguments["backend"] : "x11"};
+  const float DURATION{(commandlineArguments.count("duration") != 0) ? std::stof(commandlineArguments["duration"]) : 5.0f};
+  const bool SEND_ON_CHANGE{commandlineArguments.count("send_on_change") != 0};
+  const bool X11_INPUT_ONLY{commandlineArguments.count("x11_input_only") != 0};
+  std::vector<float> RATES;
+  {
+    std::stringstream sstr((commandlineArguments.count("rates") != 0) ? commandlineArguments["rates"] : "2,10,50");
+    std::string rate;
+    while (std::getline(sstr, rate, ',')) {
+      RATES.push_back(std::stof(rate));
+    }
+  }
+  if ((0.0f >= DURATION) || (0.0f >= std::stof(FREQ)) || RATES.empty() || (commandlineArguments.count("help") != 0)) {
+    std::cerr << argv[0] << " starts Xvfb and opendlv-device-gamepad, injects key presses with XTest, and measures the ActuationRequests received on the OD4Session." << std::endl;
+    std::cerr << "Usage:   " << argv[0] << " [--gamepad=<path to opendlv-device-gamepad>] [--display=:99] [--cid=199] [--freq=100] [--backend=x11|xi2] [--x11_input_only] [--send_on_change] [--rates=<key transitions per second>[,...]] [--duration=<seconds per rate>]" << std::endl;
+    std::cerr << "Example: " << argv[0] << " --freq=1000 --send_on_change --rates=10,100,500" << std::endl;
+    std::cerr << "         It also reports how long after its start opendlv-device-gamepad sent its first ActuationRequest and reacted to its first key." << std::endl;
+    return 1;
+  }
+
+  // Pressed keys give an acceleration of 1, released ones 0.
+  std::atomic<int64_t> injectedAt{0};
+  std::atomic<bool> isPressed{false};
+  std::atomic<uint64_t> received{0};
+  std::atomic<int64_t> lastArrival{0};
+  std::atomic<int64_t> firstArrival{0};
+  LatencyHistogram keyToReceive;
+  LatencyHistogram interArrival;
+  auto onActuationRequest = [&injectedAt, &isPressed, &received, &lastArrival, &firstArrival, &keyToReceive, &interArrival](cluon::data::Envelope &&env) {
+    const int64_t now{monotonic::nowInMicroseconds()};
+    auto msg = cluon::extractMessage<opendlv::proxy::ActuationRequest>(std::move(env));
+    int64_t first{0};
+    firstArrival.compare_exchange_strong(first, now);
+    if (0 != lastArrival.load()) {
+      interArrival.record(now - lastArrival.load());
+    }
+    lastArrival = now;
+    received++;
+
+    // Only the first ActuationRequest that reflects the injected transition counts.
+    int64_t injected{injectedAt.load()};
+    if ((0 != injected) && ((0.5f < msg.acceleration()) == isPressed.load()) && injectedAt.compare_exchange_strong(injected, 0)) {
+      keyToReceive.record(now - injected);
+    }
+  };
+  cluon::OD4Session od4{CID};
+  od4.dataTrigger(opendlv::proxy::ActuationRequest::ID(), onActuationRequest);
+  if (!od4.isRunning()) {
+    std::cerr << "Cannot join the OD4Session." << std::endl;
+    return 1;
+  }
+
+  const pid_t xvfb{spawn({"Xvfb", DISPLAY, "-nolisten", "tcp", "-screen", "0", "320x240x24"}, DISPLAY)};
+  Display *display{nullptr};
+  for (uint32_t i{0}; (0 < xvfb) && (nullptr == display) && (i < 100); i++) {
+    using namespace std::chrono_literals;
+    std::this_thread::sleep_for(50ms);
+    display = XOpenDisplay(DISPLAY.c_str());
+  }
+  int eventBase{0};
+  int errorBase{0};
+  int major{0};
+  int minor{0};
+  if ((nullptr == display) || !XTestQueryExtension(display, &eventBase, &errorBase, &major, &minor)) {
+    std::cerr << "Cannot start Xvfb with XTest on " << DISPLAY << "." << std::endl;
+    if (nullptr != display) {
+      XCloseDisplay(display);
+    }
+    terminate(xvfb, SIGTERM);
+    return 1;
+  }
+  const KeyCode KEY{XKeysymToKeycode(display, XK_Up)};
+
+  std::vector<std::string> arguments{GAMEPAD, "--cid=" + std::to_string(CID), "--freq=" + FREQ, "--device=" + DISPLAY,
+      "--backend=" + BACKEND, "--axis_leftright=0", "--axis_updown=1", "--acc_min=0", "--acc_max=1", "--dec_min=0",
+      "--dec_max=-1", "--steering_min=-1", "--steering_max=1", "--bindings=up:acc"};
+  if (SEND_ON_CHANGE) {
+    arguments.push_back("--send_on_change");
+  }
+  if (X11_INPUT_ONLY) {
+    arguments.push_back("--x11_input_only");
+  }
+  const int64_t startedAt{monotonic::nowInMicroseconds()};
+  const pid_t gamepad{spawn(arguments, DISPLAY)};
+
+  // The window needs to be mapped and focused before keys reach it.
+  while ((0 == received.load()) && (monotonic::nowInMicroseconds() - startedAt < 5 * 1000 * 1000)) {
+    using namespace std::chrono_literals;
+    std::this_thread::sleep_for(10ms);
+  }
+  int32_t retCode{0};
+  if (0 == received.load()) {
+    std::cerr << "Did not receive any ActuationRequest from " << GAMEPAD << "." << std::endl;
+    retCode = 1;
+  } else {
+    // Press the key until it is reflected to find out when the window takes
+    // keys; every attempt waits for two periods before it is repeated.
+    const int64_t ATTEMPT{2 * static_cast<int64_t>(1000.0f * 1000.0f / std::stof(FREQ)) + 5 * 1000};
+    int64_t firstKey{0};
+    while ((0 == firstKey) && (monotonic::nowInMicroseconds() - startedAt < 10 * 1000 * 1000)) {
+      isPressed = true;
+      injectedAt = monotonic::nowInMicroseconds();
+      XTestFakeKeyEvent(display, KEY, True, CurrentTime);
+      XFlush(display);
+      const int64_t attemptedAt{monotonic::nowInMicroseconds()};
+      while ((0 != injectedAt.load()) && (monotonic::nowInMicroseconds() - attemptedAt < ATTEMPT)) {
+        using namespace std::chrono_literals;
+        std::this_thread::sleep_for(100us);
+      }
+      if (0 == injectedAt.exchange(0)) {
+        firstKey = lastArrival.load();
+      }
+      XTestFakeKeyEvent(display, KEY, False, CurrentTime);
+      XFlush(display);
+    }
+    isPressed = false;
+
+    using namespace std::chrono_literals;
+    std::this_thread::sleep_for(500ms);
+    injectedAt = 0;
+    std::cout << "key-to-receive latency and send rate of " << GAMEPAD << " --backend=" << BACKEND << " --freq=" << FREQ
+              << (X11_INPUT_ONLY ? " --x11_input_only" : "") << (SEND_ON_CHANGE ? " --send_on_change" : "") << std::endl
+              << std::fixed << std::setprecision(1)
+              << "first ActuationRequest received " << static_cast<double>(firstArrival.load() - startedAt) / 1000.0 << " ms after start, first key reflected ";
+    if (0 != firstKey) {
+      std::cout << static_cast<double>(firstKey - startedAt) / 1000.0 << " ms after start" << std::endl;
+    } else {
+      std::cout << "never" << std::endl;
+    }
+    for (const float RATE : RATES) {
+      keyToReceive.reset();
+      interArrival.reset();
+      uint64_t injected{0};
+      uint64_t unmatched{0};
+      const uint64_t receivedBefore{received.load()};
+      const double cpuBefore{cpuTime(gamepad)};
+      const int64_t PERIOD{static_cast<int64_t>(1000.0 * 1000.0 * 1000.0 / static_cast<double>(RATE))};
+      const int64_t start{monotonic::nowInNanoseconds()};
+      const uint64_t TRANSITIONS{static_cast<uint64_t>(DURATION * RATE)};
+      for (uint64_t i{0}; i < TRANSITIONS; i++) {
+        sleepUntil(start + static_cast<int64_t>(i) * PERIOD);
+        // A transition that has not arrived until the next one is lost.
+        if (0 != injectedAt.exchange(0)) {
+          unmatched++;
+        }
+        const bool pressed{!isPressed.load()};
+        isPressed = pressed;
+        injectedAt = monotonic::nowInMicroseconds();
+        XTestFakeKeyEvent(display, KEY, pressed ? True : False, CurrentTime);
+        XFlush(display);
+        injected++;
+      }
+      sleepUntil(start + static_cast<int64_t>(TRANSITIONS) * PERIOD);
+      if (0 != injectedAt.exchange(0)) {
+        unmatched++;
+      }
+      const double elapsed{static_cast<double>(monotonic::nowInNanoseconds() - start) / 1e9};
+      const double cpu{cpuTime(gamepad) - cpuBefore};
+
+      std::cout << std::fixed << std::setprecision(1) << RATE << " transitions/s: injected = " << injected
+                << ", unmatched = " << unmatched << std::endl
+                << "  key-to-receive: " << keyToReceive.summary(" us") << std::endl
+                << "  received " << static_cast<double>(received.load() - receivedBefore) / elapsed << " ActuationRequests/s (--freq=" << FREQ
+                << "), inter-arrival: " << interArrival.summary(" us") << std::endl
+                << "  CPU = " << std::setprecision(2) << 100.0 * cpu / elapsed << " % of one core" << std::endl;
+    }
+    // Leave the key released.
+    if (isPressed.load()) {
+      XTestFakeKeyEvent(display, KEY, False, CurrentTime);
+      XFlush(display);
+    }
+  }
+
+  terminate(gamepad, SIGINT);
+  XCloseDisplay(display);
+  terminate(xvfb, SIGTERM);
+  return retCode;
+}
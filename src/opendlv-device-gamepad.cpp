@@ -17,44 +17,64 @@
 
 #include "cluon-complete.hpp"
 #include "actuationrequestmessage.hpp"
-
-#include <linux/joystick.h>
+#include "actuation-state.hpp"
+#include "async-logger.hpp"
+#include "axis-table.hpp"
+#include "control-shaper.hpp"
+#include "deadline-scheduler.hpp"
+#include "envelope-recorder.hpp"
+#include "evdev-input-backend.hpp"
+#include "input-arbiter.hpp"
+#include "input-event-loop.hpp"
+#include "input-watchdog.hpp"
+#include "joystick-input-backend.hpp"
+#include "key-bindings.hpp"
+#include "latency-histogram.hpp"
+#include "monotonic-time.hpp"
+#include "realtime.hpp"
+#include "script-input-backend.hpp"
+#include "shared-actuation-request.hpp"
+#include "triple-buffer.hpp"
+#include "vehicle.hpp"
+#include "x11-input-backend.hpp"
+#include "xinput2-input-backend.hpp"
+
+#include <linux/input.h>
 #include <fcntl.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <sstream>
 #include <string>
 #include <thread>
-
-#include <X11/Xlib.h>
-#include <X11/Xatom.h>
-#include <GL/glx.h>
-#include <gainput/gainput.h>
-
-namespace {
-enum Button {
-  ButtonLeft,
-  ButtonQuit
-};
-
-const char *windowName = "Gainput basic sample";
-const int width = 800;
-const int height = 600;
-}
+#include <utility>
+#include <vector>
 
 int32_t main(int32_t argc, char **argv) {
+  const int64_t START_TIME{monotonic::nowInMicroseconds()};
   int32_t retCode{0};
   auto commandlineArguments = cluon::getCommandlineArguments(argc, argv);
   if ((0 == commandlineArguments.count("cid")) ||
-      (0 == commandlineArguments.count("device")) ||
+      ((0 == commandlineArguments.count("device")) && (0 == commandlineArguments.count("input_script"))) ||
       (0 == commandlineArguments.count("freq")) ||
       (0 == commandlineArguments.count("axis_leftright")) ||
       (0 == commandlineArguments.count("axis_updown")) ||
@@ -68,11 +88,47 @@ int32_t main(int32_t argc, char **argv) {
               << " interfaces with the given PS3 controller to emit ActuationRequest messages to an OD4Session."
               << std::endl;
     std::cerr << "Usage:   " << argv[0]
-              << " --device=<PS3 controller device> --freq=<frequency in Hz>--acc_min=<minimum acceleration> --acc_max=<maximum acceleration> --dec_min=<minimum deceleration> --dec_max=<maximum deceleration> --steering_min=<minimum steering> --steering_max=<maximum steering> [--steering_max_rate=5.0] --cid=<OpenDaVINCI session> [--ps4] [--verbose]"
+              << " --device=<input device>[,<input device>...] --freq=<frequency in Hz>--acc_min=<minimum acceleration> --acc_max=<maximum acceleration> --dec_min=<minimum deceleration> --dec_max=<maximum deceleration> --steering_min=<minimum steering> --steering_max=<maximum steering> [--steering_max_rate=5.0] [--{acc,steering}_{deadband,smoothing,max_rate,max_jerk}=<value>] [--bindings=<key>:<acc|dec|left|right>[:<ramp time in s>[:<exponent>]],...] --cid=<OpenDaVINCI session> [--sender_stamp=<senderStamp>] [--vehicles=<file>] [--backend=x11|xi2|evdev|joystick[,...]] [--input_script=<file> [--input_script_fast] [--input_script_exit]] [--arbitration=priority|first_wins] [--override_keys=<key>[,...]] [--grab] [--x11_input_only] [--send_on_change] [--catch_up=skip|burst] [--input_timeout=<seconds>] [--input_timeout_action=zero|stop] [--sender_priority=<1..99>] [--sender_cpu=<CPU>] [--input_priority=<1..99>] [--input_cpu=<CPU>] [--mlockall] [--latency_report] [--latency_report_interval=<seconds>] [--startup_profile] [--statistics_interval=<seconds>] [--rec=<file>] [--shm=<name>] [--ps4] [--verbose]"
               << std::endl;
     std::cerr << "Example: " << argv[0]
               << " --device=/dev/input/js0 --axis_leftright=0 --axis_updown=4 --freq=100 --acc_min=0 --acc_max=50 --dec_min=0 --dec_max=-10 --steering_min=-10 --steering_max=10 --steering_max_rate=5.0 --cid=111"
               << std::endl;
+    std::cerr << "         --*_deadband zeroes small inputs, --*_smoothing low-pass filters with the given time constant in s, --*_max_rate and --*_max_jerk limit the change per s and s^2."
+              << std::endl;
+    std::cerr << "         --bindings maps held keys to actuation ramping from the *_min to the *_max limit; default: " << KeyBindings::DEFAULT
+              << std::endl;
+    std::cerr << "         --vehicles drives one vehicle per line of the file instead; each line overrides the arguments above, e.g. --cid=112 --sender_stamp=1 --bindings=i:acc,k:dec,j:left,l:right"
+              << std::endl;
+    std::cerr << "         --backend=joystick reads the gamepad given by --device (default for /dev/input/js*); --axis_* select the axes for steering and acceleration."
+              << std::endl;
+    std::cerr << "         --backend=evdev reads the keyboard from the event device given by --device without an X server; --grab takes exclusive access to it."
+              << std::endl;
+    std::cerr << "         --backend=xi2 captures raw key events of the whole X display, regardless of which window has the focus."
+              << std::endl;
+    std::cerr << "         --input_script replays lines of '<time in s> <key> <press|release>' from a file as an additional device of lowest priority that stays idle after the last one, --input_script_fast replays them as fast as possible, --input_script_exit ends the microservice after the last one; --device is optional then."
+              << std::endl;
+    std::cerr << "         Several comma-separated devices are read at once in order of priority; --arbitration=first_wins keeps control with the device that became active first, a device holding one of --override_keys always takes control."
+              << std::endl;
+    std::cerr << "         --x11_input_only captures keys with a focused 1x1 InputOnly window instead of a regular window."
+              << std::endl;
+    std::cerr << "         --send_on_change sends an ActuationRequest as soon as the input changes in addition to the periodic ones."
+              << std::endl;
+    std::cerr << "         --catch_up=burst sends missed periodic ActuationRequests back to back (at most 8) instead of skipping them."
+              << std::endl;
+    std::cerr << "         --input_timeout sends zero acceleration and steering while the input thread or one of its devices (X server round trip, device presence) has been stalled for longer than the given time, --input_timeout_action=stop ends the microservice instead."
+              << std::endl;
+    std::cerr << "         --*_priority runs the sender or input thread with SCHED_FIFO, --*_cpu pins it to a CPU, --mlockall locks and pre-faults memory."
+              << std::endl;
+    std::cerr << "         --latency_report prints the distribution of the time from a key event until its ActuationRequest was sent on exit, --latency_report_interval also periodically."
+              << std::endl;
+    std::cerr << "         --startup_profile prints how long each phase of the start took until the first ActuationRequest was sent."
+              << std::endl;
+    std::cerr << "         --statistics_interval publishes the sender's timing statistics as SenderStatistics periodically."
+              << std::endl;
+    std::cerr << "         --rec writes every envelope that is sent to the given .rec file."
+              << std::endl;
+    std::cerr << "         --shm publishes the latest ActuationRequest of every vehicle to the given shared memory segment for consumers on the same host (see shared-actuation-request.hpp)."
+              << std::endl;
     retCode = 1;
   } else {
     const int32_t MIN_AXES_VALUE = -32768;
@@ -81,194 +137,618 @@ int32_t main(int32_t argc, char **argv) {
     const bool VERBOSE{commandlineArguments.count("verbose") != 0};
     const uint8_t AXIS_LEFTRIGHT = std::stoi(commandlineArguments["axis_leftright"]);
     const uint8_t AXIS_UPDOWN = std::stoi(commandlineArguments["axis_updown"]);
-    const std::string DEVICE{commandlineArguments["device"]};
+    const std::string DEVICE{(commandlineArguments.count("device") != 0) ? commandlineArguments["device"] : ""};
 
     const float FREQ = std::stof(commandlineArguments["freq"]);
-    const float ACCELERATION_MIN = std::stof(commandlineArguments["acc_min"]);
-    const float ACCELERATION_MAX = std::stof(commandlineArguments["acc_max"]);
-    const float DECELERATION_MIN = std::stof(commandlineArguments["dec_min"]);
-    const float DECELERATION_MAX = std::stof(commandlineArguments["dec_max"]);
-    const float STEERING_MIN = std::stof(commandlineArguments["steering_min"]);
-    const float STEERING_MAX = std::stof(commandlineArguments["steering_max"]);
-
-    float const STEERING_MAX_RATE = (commandlineArguments.count("steering_max_rate") != 0) ? std::stof(
-        commandlineArguments["steering_max_rate"]) : -1.0f;
     float const TS = 1.0f / FREQ;
 
+    // Every line of --vehicles describes one vehicle; otherwise, the command line describes the only one.
+    std::vector<std::map<std::string, std::string>> VEHICLE_ARGUMENTS{{commandlineArguments}};
+    if (commandlineArguments.count("vehicles") != 0) {
+      VEHICLE_ARGUMENTS = Vehicle::argumentsFromFile(commandlineArguments["vehicles"], commandlineArguments);
+      if (VEHICLE_ARGUMENTS.empty()) {
+        std::cerr << "Cannot read vehicles from " << commandlineArguments["vehicles"] << "." << std::endl;
+        return 1;
+      }
+    }
+    std::vector<VehicleConfig> VEHICLE_CONFIGS;
+    for (auto &arguments : VEHICLE_ARGUMENTS) {
+      VEHICLE_CONFIGS.push_back(Vehicle::configFromArguments(arguments));
+    }
+    auto split = [](const std::string &str) {
+      std::vector<std::string> retVal;
+      std::stringstream sstr(str);
+      std::string item;
+      while (std::getline(sstr, item, ',')) {
+        retVal.push_back(item);
+      }
+      return retVal;
+    };
+    // One backend per device; the last one given also applies to the remaining devices.
+    std::vector<std::string> DEVICES{split(DEVICE)};
+    std::vector<std::string> BACKENDS{split((commandlineArguments.count("backend") != 0) ? commandlineArguments["backend"] : "")};
+    for (size_t i{BACKENDS.size()}; i < DEVICES.size(); i++) {
+      BACKENDS.push_back(!BACKENDS.empty() ? BACKENDS.back() : ((std::string::npos != DEVICES[i].find("/js")) ? "joystick" : "x11"));
+    }
+    BACKENDS.resize(DEVICES.size());
+    if (commandlineArguments.count("input_script") != 0) {
+      DEVICES.push_back(commandlineArguments["input_script"]);
+      BACKENDS.push_back("script");
+    }
+    const bool INPUT_SCRIPT_FAST{commandlineArguments.count("input_script_fast") != 0};
+    const bool INPUT_SCRIPT_EXIT{commandlineArguments.count("input_script_exit") != 0};
+    const Arbitration ARBITRATION{((commandlineArguments.count("arbitration") != 0) && ("first_wins" == commandlineArguments["arbitration"])) ? Arbitration::FIRST_WINS : Arbitration::PRIORITY};
+    std::vector<uint16_t> OVERRIDE_KEYS;
+    for (const auto &key : split((commandlineArguments.count("override_keys") != 0) ? commandlineArguments["override_keys"] : "")) {
+      OVERRIDE_KEYS.push_back(KeyBindings::codeOf(key));
+      if (KEY_RESERVED == OVERRIDE_KEYS.back()) {
+        std::cerr << "Unknown override key '" << key << "'." << std::endl;
+        return 1;
+      }
+    }
+    if ((DEVICES.empty()) || (InputArbiter::MAX_DEVICES < DEVICES.size())) {
+      std::cerr << "Cannot use " << DEVICES.size() << " input devices." << std::endl;
+      return 1;
+    }
+    const bool GRAB{commandlineArguments.count("grab") != 0};
+    const bool X11_INPUT_ONLY{commandlineArguments.count("x11_input_only") != 0};
+    const bool SEND_ON_CHANGE{commandlineArguments.count("send_on_change") != 0};
+    const int32_t SENDER_PRIORITY{(commandlineArguments.count("sender_priority") != 0) ? std::stoi(commandlineArguments["sender_priority"]) : 0};
+    const int32_t SENDER_CPU{(commandlineArguments.count("sender_cpu") != 0) ? std::stoi(commandlineArguments["sender_cpu"]) : -1};
+    const int32_t INPUT_PRIORITY{(commandlineArguments.count("input_priority") != 0) ? std::stoi(commandlineArguments["input_priority"]) : 0};
+    const int32_t INPUT_CPU{(commandlineArguments.count("input_cpu") != 0) ? std::stoi(commandlineArguments["input_cpu"]) : -1};
+    const bool MLOCKALL{commandlineArguments.count("mlockall") != 0};
+    const float LATENCY_REPORT_INTERVAL{(commandlineArguments.count("latency_report_interval") != 0) ? std::stof(commandlineArguments["latency_report_interval"]) : 0.0f};
+    const float STATISTICS_INTERVAL{(commandlineArguments.count("statistics_interval") != 0) ? std::stof(commandlineArguments["statistics_interval"]) : 0.0f};
+    const bool LATENCY_REPORT{(commandlineArguments.count("latency_report") != 0) || (0.0f < LATENCY_REPORT_INTERVAL)};
+    const float INPUT_TIMEOUT{(commandlineArguments.count("input_timeout") != 0) ? std::stof(commandlineArguments["input_timeout"]) : 0.0f};
+    const bool INPUT_TIMEOUT_STOPS{(commandlineArguments.count("input_timeout_action") != 0) && ("stop" == commandlineArguments["input_timeout_action"])};
+    const std::string REC{(commandlineArguments.count("rec") != 0) ? commandlineArguments["rec"] : ""};
+    const std::string SHM{(commandlineArguments.count("shm") != 0) ? commandlineArguments["shm"] : ""};
+    const bool STARTUP_PROFILE{commandlineArguments.count("startup_profile") != 0};
+
+    // Time since START_TIME at the end of each phase of the start.
+    std::vector<std::pair<std::string, int64_t>> startupPhases;
+    auto startupPhase = [&START_TIME, &startupPhases](const std::string &phase) {
+      startupPhases.emplace_back(phase, monotonic::nowInMicroseconds() - START_TIME);
+    };
+    startupPhase("arguments parsed");
+    const CatchUpPolicy CATCH_UP_POLICY{((commandlineArguments.count("catch_up") != 0) && ("burst" == commandlineArguments["catch_up"])) ? CatchUpPolicy::BURST : CatchUpPolicy::SKIP};
+
+    // Every part of the real-time profile is opt-in and skipped with a warning if not permitted.
+    auto applyRealtimeProfile = [&MLOCKALL](const std::string &name, int32_t priority, int32_t cpu) {
+      if (MLOCKALL) {
+        realtime::prefaultStack();
+      }
+      if (0 < priority) {
+        realtime::setFifoPriority(name, priority);
+      }
+      if (0 <= cpu) {
+        realtime::pinToCpu(name, cpu);
+      }
+    };
+    if (MLOCKALL) {
+      realtime::lockMemory();
+      startupPhase("memory locked");
+    }
+
     {
-      static int attributeListDbl[] = {GLX_RGBA, GLX_DOUBLEBUFFER, /*In case single buffering is not supported*/
-                                       GLX_RED_SIZE, 1, GLX_GREEN_SIZE, 1, GLX_BLUE_SIZE, 1,
-                                       None};
+      // Verbose output and periodic reports must not block the threads they are meant to observe.
+      std::unique_ptr<AsyncLogger> logger{(VERBOSE || (0.0f < LATENCY_REPORT_INTERVAL)) ? std::make_unique<AsyncLogger>(stdout) : nullptr};
+
+      const uint16_t CID{static_cast<uint16_t>(std::stoi(commandlineArguments["cid"]))};
+
+      // All bindings are compiled into lookup tables before any input arrives.
+      std::vector<std::unique_ptr<Vehicle>> vehicles;
+      for (const auto &config : VEHICLE_CONFIGS) {
+        vehicles.push_back(std::make_unique<Vehicle>(config, static_cast<uint32_t>(DEVICES.size()), ARBITRATION, OVERRIDE_KEYS,
+                                                     MIN_AXES_VALUE, static_cast<int32_t>(MAX_AXES_VALUE)));
+        if (!vehicles.back()->keyBindings.isValid()) {
+          return -1;
+        }
+      }
 
-      Display *xDisplay = XOpenDisplay(0);
-      if (xDisplay == 0) {
-        std::cerr << "Cannot connect to X server." << std::endl;
+      startupPhase("vehicles set up");
+
+      // The input thread owns every vehicle's inputState and hands it over
+      // to the periodic sender through actuationState; both sides are wait-free.
+      int64_t oldestInputTimeStamp{0};
+      std::atomic<bool> hasError{false};
+
+      // Key codes are Linux input event codes for every backend. Every
+      // device has its own state per vehicle; the vehicle's arbiter selects
+      // the one in control.
+      auto onKey = [&vehicles, &oldestInputTimeStamp, &hasError](uint32_t device, uint16_t code, bool pressed, int64_t timeStamp) {
+        if (0 == oldestInputTimeStamp) {
+          oldestInputTimeStamp = timeStamp;
+        }
+        for (auto &vehicle : vehicles) {
+          if (vehicle->inputArbiter.onKey(device, code, pressed, timeStamp)) {
+            vehicle->hasInputChanged = true;
+          }
+        }
+        if (!pressed && (KEY_ESC == code)) {
+          hasError = true;
+        }
+      };
+
+      // Both axes are mapped through each vehicle's tables of all raw positions computed up front.
+      auto onAxis = [&AXIS_LEFTRIGHT,
+                     &AXIS_UPDOWN,
+                     &MAX_AXES_VALUE,
+                     &vehicles,
+                     &oldestInputTimeStamp](uint32_t device, uint8_t axis, int16_t value, int64_t timeStamp) {
+        if ((AXIS_LEFTRIGHT != axis) && (AXIS_UPDOWN != axis)) {
+          return;
+        }
+        if (0 == oldestInputTimeStamp) {
+          oldestInputTimeStamp = timeStamp;
+        }
+        // Sticks at rest are not exactly centered; only a tenth of the range claims control.
+        const bool isDeflected{static_cast<int32_t>(MAX_AXES_VALUE / 10) < std::abs(static_cast<int32_t>(value))};
+        for (auto &vehicle : vehicles) {
+          // Pushing the stick forward gives negative values.
+          const bool hasChanged{(AXIS_LEFTRIGHT == axis)
+              ? vehicle->inputArbiter.onAxis(device, InputArbiter::Axis::STEERING, vehicle->steeringAxis.map(value), isDeflected, timeStamp)
+              : vehicle->inputArbiter.onAxis(device, InputArbiter::Axis::ACCELERATION, vehicle->accelerationAxis.map(value), isDeflected, timeStamp)};
+          if (hasChanged) {
+            vehicle->hasInputChanged = true;
+          }
+        }
+      };
+
+      // Opening and grabbing the input devices (X server connections, device
+      // probing) overlaps with setting up the senders, the shared memory, and
+      // the recorder; nothing touches the backends until they are joined.
+      std::vector<std::unique_ptr<InputBackend>> inputBackends;
+      ScriptInputBackend *scriptInputBackend{nullptr};
+      std::future<bool> inputBackendsOpened{std::async(std::launch::async, [&DEVICES,
+                                                                                 &BACKENDS,
+                                                                                 &INPUT_SCRIPT_FAST,
+                                                                                 &GRAB,
+                                                                                 &X11_INPUT_ONLY,
+                                                                                 &OVERRIDE_KEYS,
+                                                                                 &vehicles,
+                                                                                 &onKey,
+                                                                                 &onAxis,
+                                                                                 &inputBackends,
+                                                                                 &scriptInputBackend]() {
+        for (uint32_t i{0}; i < DEVICES.size(); i++) {
+          KeyDelegate keyDelegate{[&onKey, i](uint16_t code, bool pressed, int64_t timeStamp) {
+            onKey(i, code, pressed, timeStamp);
+          }};
+          std::unique_ptr<InputBackend> inputBackend;
+          if ("joystick" == BACKENDS[i]) {
+            inputBackend = std::make_unique<JoystickInputBackend>(DEVICES[i], keyDelegate, [&onAxis, i](uint8_t axis, int16_t value, int64_t timeStamp) {
+              onAxis(i, axis, value, timeStamp);
+            });
+          } else if ("script" == BACKENDS[i]) {
+            auto script = std::make_unique<ScriptInputBackend>(DEVICES[i], !INPUT_SCRIPT_FAST, keyDelegate);
+            scriptInputBackend = script.get();
+            inputBackend = std::move(script);
+          } else if ("evdev" == BACKENDS[i]) {
+            inputBackend = std::make_unique<EvdevInputBackend>(DEVICES[i], GRAB, keyDelegate);
+          } else {
+            std::vector<uint16_t> keys;
+            for (const auto &vehicle : vehicles) {
+              const std::vector<uint16_t> boundKeys{vehicle->keyBindings.keys()};
+              keys.insert(keys.end(), boundKeys.begin(), boundKeys.end());
+            }
+            keys.insert(keys.end(), OVERRIDE_KEYS.begin(), OVERRIDE_KEYS.end());
+            keys.push_back(KEY_ESC);
+            if ("xi2" == BACKENDS[i]) {
+              inputBackend = std::make_unique<XInput2InputBackend>(keys, keyDelegate);
+            } else {
+              inputBackend = std::make_unique<X11InputBackend>(keys, X11_INPUT_ONLY, keyDelegate);
+            }
+            if (!inputBackend->isValid()) {
+              std::cerr << "Cannot connect to X server." << std::endl;
+            }
+          }
+          if (!inputBackend->isValid()) {
+            return false;
+          }
+          inputBackends.push_back(std::move(inputBackend));
+        }
+        return true;
+      })};
+
+      // Sent envelopes are handed over to the recorder's writer thread without blocking.
+      std::unique_ptr<EnvelopeRecorder> recorder{!REC.empty() ? std::make_unique<EnvelopeRecorder>(REC) : nullptr};
+      if ((nullptr != recorder) && !recorder->isValid()) {
         return -1;
       }
 
-      Window root = DefaultRootWindow(xDisplay);
-
-      XVisualInfo *vi = glXChooseVisual(xDisplay, DefaultScreen(xDisplay), attributeListDbl);
-      assert(vi);
-
-      GLXContext context = glXCreateContext(xDisplay, vi, 0, GL_TRUE);
-
-      Colormap cmap = XCreateColormap(xDisplay, root, vi->visual, AllocNone);
-
-      XSetWindowAttributes swa;
-      swa.colormap = cmap;
-      swa.event_mask = ExposureMask
-                       | KeyPressMask | KeyReleaseMask
-                       | PointerMotionMask | ButtonPressMask | ButtonReleaseMask;
-
-      Window xWindow = XCreateWindow(
-          xDisplay, root,
-          0, 0, width, height, 0,
-          CopyFromParent, InputOutput,
-          CopyFromParent, CWEventMask,
-          &swa
-      );
-
-      glXMakeCurrent(xDisplay, xWindow, context);
-
-      XSetWindowAttributes xattr;
-      xattr.override_redirect = False;
-      XChangeWindowAttributes(xDisplay, xWindow, CWOverrideRedirect, &xattr);
-
-      XMapWindow(xDisplay, xWindow);
-      XStoreName(xDisplay, xWindow, windowName);
-
-      // Setup Gainput
-      gainput::InputManager manager;
-      const gainput::DeviceId keyboardId = manager.CreateDevice<gainput::InputDeviceKeyboard>();
-
-      gainput::InputMap map(manager);
-      map.MapBool(ButtonLeft, keyboardId, gainput::KeyA);
-      map.MapBool(ButtonQuit, keyboardId, gainput::KeyEscape);
-
-      manager.SetDisplaySize(width, height);
-
-      std::mutex valuesMutex;
-      float acceleration{0};
-      float steering{0};
-      float targetSteering{0};
-      float prevSteering{0};
-      bool hasError{false};
-
-      // Thread to read values.
-      std::thread gamepadReadingThread([&AXIS_LEFTRIGHT,
-                                           &AXIS_UPDOWN,
-                                           &MIN_AXES_VALUE,
-                                           &MAX_AXES_VALUE,
-                                           &VERBOSE,
-                                           &ACCELERATION_MIN,
-                                           &ACCELERATION_MAX,
-                                           &DECELERATION_MIN,
-                                           &DECELERATION_MAX,
-                                           &STEERING_MIN,
-                                           &STEERING_MAX,
-                                           &STEERING_MAX_RATE,
-                                           &valuesMutex,
-                                           &acceleration,
-                                           &steering,
-                                           &targetSteering,
-                                           &hasError,
-                                           &xDisplay,
-                                           &manager,
-                                           &map]() {
-
-        while (!hasError) {
-          // Define timeout for select system call. The timeval struct must be
-          // reinitialized for every select call as it might be modified containing
-          // the actual time slept.
-
-          if (true) {
-
-            while (!hasError) {
-              manager.Update();
-              XEvent event;
-              while (XPending(xDisplay)) {
-                XNextEvent(xDisplay, &event);
-                manager.HandleEvent(event);
-              }
-              float percent{0};
-              std::unique_lock<std::mutex> lck(valuesMutex);
-              if (map.GetBoolWasDown(ButtonLeft)) {
-                percent++;
-                std::cout << "<<<<<<<" << std::endl;
-              }
-              if (map.GetBoolWasDown(ButtonQuit)) {
-                hasError = true;
-                break;
-              }
-              lck.unlock();
-              using namespace std::chrono_literals;
+      // Vehicles share one plain UDP sender per CID; nothing is received, so
+      // no OD4Session and its receiving thread are needed.
+      std::map<uint16_t, std::unique_ptr<cluon::UDPSender>> senders;
+      for (auto &vehicle : vehicles) {
+        auto &sender = senders[vehicle->config.cid];
+        if (nullptr == sender) {
+          sender = std::make_unique<cluon::UDPSender>("225.0.0." + std::to_string(vehicle->config.cid), 12175);
+        }
+        vehicle->sender = sender.get();
+      }
+      if (nullptr == senders[CID]) {
+        senders[CID] = std::make_unique<cluon::UDPSender>("225.0.0." + std::to_string(CID), 12175);
+      }
 
-              std::this_thread::sleep_for(1ms);
-            }
+      // One slot per vehicle for consumers on the same host.
+      std::unique_ptr<cluon::SharedMemory> sharedMemory{!SHM.empty()
+          ? std::make_unique<cluon::SharedMemory>(SHM, static_cast<uint32_t>(vehicles.size() * sizeof(SharedActuationRequest))) : nullptr};
+      if (nullptr != sharedMemory) {
+        if (!sharedMemory->valid()) {
+          std::cerr << "Cannot create shared memory " << SHM << "." << std::endl;
+          return -1;
+        }
+        for (size_t i{0}; i < vehicles.size(); i++) {
+          vehicles[i]->sharedActuationRequest = new (sharedMemory->data() + i * sizeof(SharedActuationRequest)) SharedActuationRequest();
+        }
+      }
+
+      startupPhase("senders set up");
+
+      // Trips when the input thread has not handled its heartbeat timer within INPUT_TIMEOUT.
+      std::unique_ptr<InputWatchdog> inputWatchdog{(0.0f < INPUT_TIMEOUT) ? std::make_unique<InputWatchdog>(INPUT_TIMEOUT) : nullptr};
+      if ((nullptr != inputWatchdog) && !inputWatchdog->isValid()) {
+        std::cerr << "Cannot create the input watchdog." << std::endl;
+        return -1;
+      }
+
+      // Serializes a message like OD4Session::send and records exactly the bytes that are sent.
+      // Whether sending works is told by the results of the sends; a failed
+      // send other than a full socket buffer ends the program.
+      std::atomic<bool> isSending{true};
+      auto sendMessage = [&recorder, &hasError, &isSending](cluon::UDPSender &sender, auto &message, uint32_t senderStamp) {
+        cluon::ToProtoVisitor protoEncoder;
+        message.accept(protoEncoder);
+        cluon::data::Envelope envelope;
+        envelope.dataType(static_cast<int32_t>(message.ID()))
+            .serializedData(protoEncoder.encodedData())
+            .sent(cluon::time::now())
+            .senderStamp(senderStamp);
+        envelope.sampleTimeStamp(envelope.sent());
+        std::string data{cluon::serializeEnvelope(std::move(envelope))};
+        if (nullptr != recorder) {
+          recorder->record(data);
+        }
+        const std::pair<ssize_t, int32_t> result{sender.send(std::move(data))};
+        if ((0 > result.first) && (EAGAIN != result.second) && (EWOULDBLOCK != result.second) && (ENOBUFS != result.second)) {
+          hasError = true;
+          if (isSending.exchange(false)) {
+            std::cerr << "Cannot send: " << std::strerror(result.second) << std::endl;
           }
         }
-      });
+      };
+
+      // Sends an ActuationRequest to the vehicle's CID and with its senderStamp.
+      auto send = [&sendMessage](Vehicle &vehicle) {
+        sendMessage(*vehicle.sender, vehicle.ar, vehicle.config.senderStamp);
+        if (nullptr != vehicle.sharedActuationRequest) {
+          ActuationSample sample;
+          sample.timeStamp = monotonic::nowInNanoseconds();
+          sample.acceleration = vehicle.ar.acceleration();
+          sample.steering = vehicle.ar.steering();
+          sample.senderStamp = vehicle.config.senderStamp;
+          sample.cid = vehicle.config.cid;
+          sample.isValid = vehicle.ar.isValid();
+          // Consumers poll the sequence number; nothing they do can block the sender.
+          vehicle.sharedActuationRequest->write(sample);
+        }
+      };
+
+      // Shapes and sends an ActuationRequest; only ever called from the sender's
+      // thread, so the input thread never holds up a send and vice versa.
+      LatencyHistogram keyToSendLatency;
+      bool isFirstActuationRequest{true};
+      auto sendActuationRequest = [&VERBOSE,
+                                   &logger,
+                                   &TS,
+                                   &START_TIME,
+                                   &hasError,
+                                   &send,
+                                   &keyToSendLatency,
+                                   &inputWatchdog,
+                                   &isFirstActuationRequest](Vehicle &vehicle, const ActuationState &state) {
+        // Every send only gets the time elapsed since the previous send so
+        // that ticks right after an on-change send cannot exceed the limits.
+        const int64_t now{monotonic::nowInMicroseconds()};
+        const float elapsed{static_cast<float>(now - vehicle.lastSendTime) / 1000000.0f};
+        const float dt{std::min(elapsed, TS)};
+        float acceleration{0.0f};
+        float steering{0.0f};
+        if ((nullptr != inputWatchdog) && inputWatchdog->isTripped()) {
+          // The input is stale; stop right away instead of shaping towards zero.
+          vehicle.controlShaper.reset(acceleration, steering);
+        } else {
+          vehicle.keyBindings.evaluate(state, now, acceleration, steering);
+          vehicle.controlShaper.apply(dt, acceleration, steering);
+        }
+        vehicle.ar.acceleration(acceleration).steering(steering).isValid(!hasError);
 
-      // OD4Session to send values to.
-      opendlv::proxy::ActuationRequest ar;
-      cluon::OD4Session od4{static_cast<uint16_t>(std::stoi(commandlineArguments["cid"]))};
-      if (od4.isRunning()) {
-        od4.timeTrigger(FREQ, [&VERBOSE,
-            &STEERING_MAX_RATE,
-            &TS,
-            &valuesMutex,
-            &acceleration,
-            &steering,
-            &prevSteering,
-            &targetSteering,
-            &hasError,
-            &ar,
-            &od4]() {
-          std::lock_guard<std::mutex> lck(valuesMutex);
-
-          if (STEERING_MAX_RATE > 0.0f) {
-            float inc = TS * STEERING_MAX_RATE;
-            float steeringRate = (steering - prevSteering) / TS;
-            if (steeringRate > STEERING_MAX_RATE) {
-              steering = prevSteering + inc;
-            } else if (steeringRate < -STEERING_MAX_RATE) {
-              steering = prevSteering - inc;
+        if (VERBOSE && (nullptr != logger)) {
+          logger->log("cid = %u\nsenderStamp = %u\nacceleration = %g\nsteering = %g\nisValid = %d\n\n",
+                      static_cast<uint32_t>(vehicle.config.cid), vehicle.config.senderStamp,
+                      static_cast<double>(vehicle.ar.acceleration()), static_cast<double>(vehicle.ar.steering()), vehicle.ar.isValid() ? 1 : 0);
+        }
+        send(vehicle);
+        const int64_t lastSendTime{monotonic::nowInMicroseconds()};
+        vehicle.lastSendTime = lastSendTime;
+
+        // Only the first send after an input event accounts for its latency.
+        if ((0 != state.inputTimeStamp) && (vehicle.lastInputTimeStamp != state.inputTimeStamp)) {
+          keyToSendLatency.record(lastSendTime - state.inputTimeStamp);
+          vehicle.lastInputTimeStamp = state.inputTimeStamp;
+        }
+        if (VERBOSE && (nullptr != logger) && isFirstActuationRequest) {
+          logger->log("Sent first ActuationRequest %.3f ms after start.\n", static_cast<double>(lastSendTime - START_TIME) / 1000.0);
+        }
+        isFirstActuationRequest = false;
+      };
+
+      if (!inputBackendsOpened.get()) {
+        return -1;
+      }
+      startupPhase("input devices opened");
+
+      // Thread to read values; it blocks on all input devices until events arrive.
+      // The input thread only wakes the sender's thread for on-change sends
+      // and errors; all shaping and sending happens there.
+      const int32_t wakeSenderFd{::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+      if (-1 == wakeSenderFd) {
+        std::cerr << "Cannot create the sender's wakeup." << std::endl;
+        return -1;
+      }
+      auto wakeSender = [&wakeSenderFd]() {
+        const uint64_t one{1};
+        ssize_t const written = ::write(wakeSenderFd, &one, sizeof(one));
+        (void)written;
+      };
+
+      InputEventLoop inputEventLoop;
+      std::mutex inputThreadMutex;
+      std::condition_variable inputThreadEnded;
+      bool hasInputThreadEnded{false};
+      std::thread gamepadReadingThread([&VERBOSE,
+                                           &INPUT_SCRIPT_EXIT,
+                                           &scriptInputBackend,
+                                           &SEND_ON_CHANGE,
+                                           &vehicles,
+                                           &oldestInputTimeStamp,
+                                           &hasError,
+                                           &wakeSender,
+                                           &inputBackends,
+                                           &inputEventLoop,
+                                           &inputWatchdog,
+                                           &INPUT_PRIORITY,
+                                           &INPUT_CPU,
+                                           &applyRealtimeProfile,
+                                           &inputThreadMutex,
+                                           &inputThreadEnded,
+                                           &hasInputThreadEnded]() {
+        applyRealtimeProfile("input thread", INPUT_PRIORITY, INPUT_CPU);
+
+        auto readEvents = [&SEND_ON_CHANGE,
+                           &INPUT_SCRIPT_EXIT,
+                           &vehicles,
+                           &oldestInputTimeStamp,
+                           &hasError,
+                           &wakeSender,
+                           &scriptInputBackend](InputBackend &inputBackend, bool isProbing) {
+          // Publish once per wakeup after all pending events are applied.
+          oldestInputTimeStamp = 0;
+          for (auto &vehicle : vehicles) {
+            vehicle->hasInputChanged = false;
+          }
+          // A device that does not answer the probe blocks here, so that the heartbeat stops.
+          const bool isAvailable{(!isProbing || inputBackend.probe()) && inputBackend.readEvents()};
+          if (!isAvailable) {
+            std::cerr << "Input device is gone." << std::endl;
+            hasError = true;
+          }
+          bool hasChanged{false};
+          for (auto &vehicle : vehicles) {
+            if (vehicle->hasInputChanged) {
+              ActuationState &inputState{vehicle->inputState};
+              const int64_t inputTimeStamp{inputState.inputTimeStamp};
+              inputState = vehicle->inputArbiter.state();
+              inputState.inputTimeStamp = (0 != oldestInputTimeStamp) ? oldestInputTimeStamp : inputTimeStamp;
+              vehicle->actuationState.write(inputState);
+              hasChanged = true;
             }
           }
 
-          prevSteering = steering;
-          ar.acceleration(acceleration).steering(steering).isValid(!hasError);
+          // The script's final transitions are published before the microservice ends with it.
+          if (INPUT_SCRIPT_EXIT && (&inputBackend == scriptInputBackend) && scriptInputBackend->isFinished()) {
+            std::cerr << "Input script finished." << std::endl;
+            hasError = true;
+          }
 
-          if (VERBOSE) {
-            std::stringstream buffer;
-            ar.accept([](uint32_t, const std::string &, const std::string &) {},
-                      [&buffer](uint32_t, std::string &&, std::string &&n, auto v) {
-                        buffer << n << " = " << v << '\n';
-                      },
-                      []() {});
-            std::cout << buffer.str() << std::endl;
+          // Send right away instead of waiting for the next tick.
+          if ((SEND_ON_CHANGE && hasChanged) || hasError) {
+            wakeSender();
+          }
+          return !hasError;
+        };
+
+        bool isReady{true};
+        for (uint32_t i{0}; i < inputBackends.size(); i++) {
+          InputBackend *backend{inputBackends[i].get()};
+          // Events might be queued already before we start waiting on the device.
+          isReady = readEvents(*backend, false);
+          if (isReady && !inputEventLoop.add(backend->fileDescriptor(), [&readEvents, backend]() { return readEvents(*backend, false); })) {
+            std::cerr << "Cannot wait for events on the input device." << std::endl;
+            hasError = true;
+            isReady = false;
+          }
+          if (!isReady) {
+            break;
           }
-          od4.send(ar);
+        }
+        if (isReady && (nullptr != inputWatchdog) &&
+            !inputEventLoop.add(inputWatchdog->heartbeatFileDescriptor(), [&inputWatchdog, &inputBackends, &readEvents]() {
+              // The heartbeat only counts once every device answered, not just this loop.
+              bool isAlive{true};
+              for (uint32_t i{0}; isAlive && (i < inputBackends.size()); i++) {
+                isAlive = readEvents(*inputBackends[i], true);
+              }
+              return isAlive && inputWatchdog->onHeartbeatTimer();
+            })) {
+          std::cerr << "Cannot wait for the input watchdog's heartbeat." << std::endl;
+          hasError = true;
+          isReady = false;
+        }
+        if (isReady && !inputEventLoop.run()) {
+          std::cerr << "Cannot wait for events on the input devices." << std::endl;
+          hasError = true;
+        }
 
-          if (STEERING_MAX_RATE > 0.0f) {
-            steering = targetSteering;
+        std::lock_guard<std::mutex> lck(inputThreadMutex);
+        hasInputThreadEnded = true;
+        inputThreadEnded.notify_all();
+      });
+      startupPhase("input thread started");
+
+      if (isSending) {
+        // All vehicles are sent on the same deadlines.
+        DeadlineScheduler scheduler;
+        const int32_t sendTrigger = scheduler.add(FREQ, CATCH_UP_POLICY, [&vehicles,
+            &hasError,
+            &sendActuationRequest]() {
+          for (auto &vehicle : vehicles) {
+            // Never blocks, even while the input thread is publishing.
+            vehicle->actuationState.read(vehicle->latestState);
+            sendActuationRequest(*vehicle, vehicle->latestState);
           }
 
           // Determine whether to continue or not.
           return !hasError;
         });
+        if (!scheduler.watch(wakeSenderFd, [&wakeSenderFd, &vehicles, &hasError, &sendActuationRequest]() {
+          uint64_t counter{0};
+          ssize_t const bytesRead = ::read(wakeSenderFd, &counter, sizeof(counter));
+          (void)bytesRead;
+          // Only vehicles whose input changed since the last send; the last
+          // input is still sent before the final stop.
+          for (auto &vehicle : vehicles) {
+            if (vehicle->actuationState.read(vehicle->latestState)) {
+              sendActuationRequest(*vehicle, vehicle->latestState);
+            }
+          }
+          return !hasError;
+        })) {
+          std::cerr << "Cannot wait for the input thread." << std::endl;
+          hasError = true;
+        }
+        if ((nullptr != inputWatchdog) && !scheduler.watch(inputWatchdog->fileDescriptor(), [&INPUT_TIMEOUT_STOPS,
+            &vehicles,
+            &hasError,
+            &sendActuationRequest,
+            &inputWatchdog]() {
+          if (inputWatchdog->onTimer()) {
+            hasError = hasError || INPUT_TIMEOUT_STOPS;
+            // Do not wait for the next tick.
+            for (auto &vehicle : vehicles) {
+              sendActuationRequest(*vehicle, vehicle->latestState);
+            }
+            inputWatchdog->tripHandled();
+            std::cerr << "Input is stale; sent " << (INPUT_TIMEOUT_STOPS ? "stop." : "zero.") << std::endl;
+          }
+          return !hasError;
+        })) {
+          std::cerr << "Cannot wait for the input watchdog." << std::endl;
+          hasError = true;
+        }
+        if (0.0f < LATENCY_REPORT_INTERVAL) {
+          scheduler.add(1.0f / LATENCY_REPORT_INTERVAL, CatchUpPolicy::SKIP, [&logger, &keyToSendLatency]() {
+            // Written by the logger's thread instead of blocking the sender on stdout.
+            logger->log("Key-to-send latency: %s\n", keyToSendLatency.summary(" us").c_str());
+            return true;
+          });
+        }
+        const TriggerStatistics *sendStatistics{scheduler.statistics(sendTrigger)};
+        if ((nullptr != sendStatistics) && (0.0f < STATISTICS_INTERVAL)) {
+          cluon::UDPSender *sender{senders[CID].get()};
+          scheduler.add(1.0f / STATISTICS_INTERVAL, CatchUpPolicy::SKIP, [&sendStatistics, &sendMessage, sender]() {
+            opendlv::device::gamepad::SenderStatistics msg;
+            msg.ticks(sendStatistics->ticks.load())
+                .missedTicks(sendStatistics->missedTicks.load())
+                .latenessP50(static_cast<uint64_t>(sendStatistics->lateness.valueAtPercentile(50.0)))
+                .latenessP99(static_cast<uint64_t>(sendStatistics->lateness.valueAtPercentile(99.0)))
+                .latenessMax(static_cast<uint64_t>(sendStatistics->lateness.max()))
+                .periodErrorP99(static_cast<uint64_t>(sendStatistics->periodError.valueAtPercentile(99.0)))
+                .periodErrorMax(static_cast<uint64_t>(sendStatistics->periodError.max()))
+                .executionTimeP99(static_cast<uint64_t>(sendStatistics->executionTime.valueAtPercentile(99.0)))
+                .executionTimeMax(static_cast<uint64_t>(sendStatistics->executionTime.max()));
+            sendMessage(*sender, msg, 0);
+            return true;
+          });
+        }
+        if (nullptr == sendStatistics) {
+          std::cerr << "Cannot create the timer for sending." << std::endl;
+        } else {
+          applyRealtimeProfile("sender thread", SENDER_PRIORITY, SENDER_CPU);
+          startupPhase("sender ready");
+
+          // The first ActuationRequest goes out right away instead of one period later.
+          for (auto &vehicle : vehicles) {
+            vehicle->actuationState.read(vehicle->latestState);
+            sendActuationRequest(*vehicle, vehicle->latestState);
+          }
+          startupPhase("first ActuationRequest sent");
+          if (STARTUP_PROFILE) {
+            std::cout << "Startup profile in ms since start:" << std::endl << std::fixed << std::setprecision(3);
+            for (const auto &phase : startupPhases) {
+              std::cout << "  " << std::setw(8) << static_cast<double>(phase.second) / 1000.0 << " " << phase.first << std::endl;
+            }
+            std::cout << std::defaultfloat;
+          }
+          scheduler.run();
+          if (VERBOSE) {
+            std::cout << "Sent " << sendStatistics->ticks.load() << " periodic ActuationRequests, missed "
+                      << sendStatistics->missedTicks.load() << " deadlines." << std::endl
+                      << "Lateness: " << sendStatistics->lateness.summary(" ns") << std::endl
+                      << "Period error: " << sendStatistics->periodError.summary(" ns") << std::endl
+                      << "Execution time: " << sendStatistics->executionTime.summary(" ns") << std::endl;
+          }
+        }
+      }
 
-        // Send stop.
-        ar.acceleration(0).steering(0).isValid(true);
-        od4.send(ar);
+      // Send stop before waiting for the input thread, which might be stuck
+      // in a device, e.g. after the input watchdog tripped.
+      hasError = true;
+      inputEventLoop.stop();
+      if (isSending) {
+        for (auto &vehicle : vehicles) {
+          vehicle->ar.acceleration(0).steering(0).isValid(true);
+          send(*vehicle);
+        }
       }
 
-      // Stop thread.
+      // Everything here is still referenced by a stuck input thread; thus,
+      // the process ends without destructing it after flushing the output.
+      bool hasInputThreadStopped{false};
       {
-        std::lock_guard<std::mutex> lck(valuesMutex);
-        hasError = true;
-        gamepadReadingThread.join();
+        std::unique_lock<std::mutex> lck(inputThreadMutex);
+        hasInputThreadStopped = inputThreadEnded.wait_for(lck, std::chrono::seconds(1), [&hasInputThreadEnded]() { return hasInputThreadEnded; });
+      }
+      if (!hasInputThreadStopped) {
+        std::cerr << "Input thread does not stop; exiting without it." << std::endl;
+        gamepadReadingThread.detach();
+        logger.reset();
+        recorder.reset();
+        std::cout.flush();
+        std::quick_exit(1);
+      }
+      gamepadReadingThread.join();
+      ::close(wakeSenderFd);
+
+      if (LATENCY_REPORT) {
+        std::cout << "Key-to-send latency: " << keyToSendLatency.summary(" us") << std::endl;
+      }
+      if ((nullptr != inputWatchdog) && (VERBOSE || LATENCY_REPORT)) {
+        std::cout << "Input watchdog tripped " << inputWatchdog->trips() << " times; trip latency: "
+                  << inputWatchdog->tripLatency().summary(" us") << std::endl;
       }
 
       retCode = 0;
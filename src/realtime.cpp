@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "realtime.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace realtime {
+
+bool setFifoPriority(const std::string &name, int32_t priority) noexcept {
+  const int32_t MIN{::sched_get_priority_min(SCHED_FIFO)};
+  const int32_t MAX{::sched_get_priority_max(SCHED_FIFO)};
+  if ((priority < MIN) || (priority > MAX)) {
+    std::cerr << "[realtime]: Priority " << priority << " for " << name << " is outside [" << MIN << " .. " << MAX << "]." << std::endl;
+    return false;
+  }
+
+  struct sched_param param{};
+  param.sched_priority = priority;
+  const int32_t error{::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param)};
+  if (0 != error) {
+    std::cerr << "[realtime]: Cannot run " << name << " with SCHED_FIFO: " << ::strerror(error) << "; continuing without." << std::endl;
+  }
+  return (0 == error);
+}
+
+bool pinToCpu(const std::string &name, int32_t cpu) noexcept {
+  if ((0 > cpu) || (CPU_SETSIZE <= cpu)) {
+    std::cerr << "[realtime]: CPU " << cpu << " for " << name << " is invalid." << std::endl;
+    return false;
+  }
+
+  cpu_set_t cpuSet;
+  CPU_ZERO(&cpuSet);
+  CPU_SET(static_cast<size_t>(cpu), &cpuSet);
+  const int32_t error{::pthread_setaffinity_np(::pthread_self(), sizeof(cpuSet), &cpuSet)};
+  if (0 != error) {
+    std::cerr << "[realtime]: Cannot pin " << name << " to CPU " << cpu << ": " << ::strerror(error) << "; continuing without." << std::endl;
+  }
+  return (0 == error);
+}
+
+bool lockMemory() noexcept {
+  const bool retVal{0 == ::mlockall(MCL_CURRENT | MCL_FUTURE)};
+  if (!retVal) {
+    std::cerr << "[realtime]: Cannot lock memory: " << ::strerror(errno) << "; continuing without." << std::endl;
+  }
+  return retVal;
+}
+
+void prefaultStack() noexcept {
+  constexpr size_t PREFAULT_SIZE{128 * 1024};
+  uint8_t stack[PREFAULT_SIZE];
+  std::memset(stack, 0, PREFAULT_SIZE);
+  // Keep the compiler from optimizing the writes away.
+  __asm__ __volatile__("" : : "r"(stack) : "memory");
+}
+
+} // namespace realtime
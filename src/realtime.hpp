@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REALTIME_HPP
+#define REALTIME_HPP
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Helpers to run a thread with a real-time profile. Every function prints a
+ * warning and returns false if it is not permitted (e.g. missing
+ * CAP_SYS_NICE or RLIMIT_MEMLOCK) so that the caller can continue without it.
+ */
+namespace realtime {
+
+/**
+ * This function applies SCHED_FIFO to the calling thread.
+ *
+ * @param name Name of the thread for warnings.
+ * @param priority Priority in [1 .. 99].
+ * @return true on success.
+ */
+bool setFifoPriority(const std::string &name, int32_t priority) noexcept;
+
+/**
+ * This function pins the calling thread to one CPU.
+ *
+ * @param name Name of the thread for warnings.
+ * @param cpu Index of the CPU.
+ * @return true on success.
+ */
+bool pinToCpu(const std::string &name, int32_t cpu) noexcept;
+
+/**
+ * This function locks all current and future pages of the process into RAM.
+ *
+ * @return true on success.
+ */
+bool lockMemory() noexcept;
+
+/**
+ * This function touches the top of the calling thread's stack so that it
+ * does not page fault later on.
+ */
+void prefaultStack() noexcept;
+
+} // namespace realtime
+
+#endif
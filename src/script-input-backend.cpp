@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "script-input-backend.hpp"
+#include "key-bindings.hpp"
+#include "monotonic-time.hpp"
+
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+ScriptInputBackend::ScriptInputBackend(const std::string &file, bool isRealtime, KeyDelegate delegate) noexcept
+    : m_delegate(std::move(delegate))
+    , m_isRealtime(isRealtime) {
+  if (!load(file)) {
+    return;
+  }
+  // An eventfd with a non-zero counter stays readable until it is read.
+  m_fd = m_isRealtime ? ::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK) : ::eventfd(1, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (-1 == m_fd) {
+    std::cerr << "[ScriptInputBackend]: Cannot create the replay timer." << std::endl;
+    return;
+  }
+  m_start = monotonic::nowInMicroseconds();
+  if (m_isRealtime) {
+    armTimer();
+  }
+}
+
+ScriptInputBackend::~ScriptInputBackend() noexcept {
+  if (-1 != m_fd) {
+    ::close(m_fd);
+  }
+}
+
+bool ScriptInputBackend::isValid() const noexcept {
+  return (-1 != m_fd);
+}
+
+int32_t ScriptInputBackend::fileDescriptor() const noexcept {
+  return m_fd;
+}
+
+bool ScriptInputBackend::readEvents() noexcept {
+  if (isFinished()) {
+    // Stay valid and idle; drain a pending wakeup so that the loop does not spin.
+    uint64_t counter{0};
+    ssize_t const bytesRead = ::read(m_fd, &counter, sizeof(counter));
+    (void)bytesRead;
+    return true;
+  }
+  if (m_isRealtime) {
+    uint64_t expirations{0};
+    ssize_t const bytesRead = ::read(m_fd, &expirations, sizeof(expirations));
+    (void)bytesRead;
+
+    // Time stamps are the scheduled times, so that latencies include a late wakeup.
+    const int64_t now{monotonic::nowInMicroseconds()};
+    while ((m_next < m_transitions.size()) && (m_start + m_transitions[m_next].time <= now)) {
+      const Transition &t{m_transitions[m_next++]};
+      m_delegate(t.code, t.pressed, m_start + t.time);
+    }
+    armTimer();
+  } else if (m_next < m_transitions.size()) {
+    const Transition &t{m_transitions[m_next++]};
+    m_delegate(t.code, t.pressed, monotonic::nowInMicroseconds());
+  }
+
+  if (isFinished()) {
+    std::cerr << "[ScriptInputBackend]: Replayed " << m_transitions.size() << " key transitions in "
+              << static_cast<double>(monotonic::nowInMicroseconds() - m_start) / 1000000.0 << " s." << std::endl;
+  }
+  return true;
+}
+
+bool ScriptInputBackend::isFinished() const noexcept {
+  return m_next >= m_transitions.size();
+}
+
+bool ScriptInputBackend::probe() noexcept {
+  return true;
+}
+
+bool ScriptInputBackend::load(const std::string &file) noexcept {
+  try {
+    std::ifstream in(file);
+    if (!in.good()) {
+      std::cerr << "[ScriptInputBackend]: Cannot open " << file << "." << std::endl;
+      return false;
+    }
+    std::string line;
+    uint32_t lineNumber{0};
+    while (std::getline(in, line)) {
+      lineNumber++;
+      std::stringstream sstr(line);
+      std::string time;
+      std::string key;
+      std::string transition;
+      if (!(sstr >> time) || ('#' == time[0])) {
+        continue;
+      }
+      sstr >> key >> transition;
+      const uint16_t code{KeyBindings::codeOf(key)};
+      const double seconds{std::stod(time)};
+      if ((KEY_RESERVED == code) || (0.0 > seconds) || (("press" != transition) && ("release" != transition))) {
+        std::cerr << "[ScriptInputBackend]: Cannot parse line " << lineNumber << " of " << file << "." << std::endl;
+        return false;
+      }
+      m_transitions.push_back(Transition{std::llround(seconds * 1000.0 * 1000.0), code, "press" == transition});
+    }
+    std::stable_sort(m_transitions.begin(), m_transitions.end(), [](const Transition &a, const Transition &b) { return a.time < b.time; });
+  } catch (...) {
+    std::cerr << "[ScriptInputBackend]: Cannot parse " << file << "." << std::endl;
+    return false;
+  }
+  if (m_transitions.empty()) {
+    std::cerr << "[ScriptInputBackend]: " << file << " has no key transitions." << std::endl;
+  }
+  return !m_transitions.empty();
+}
+
+void ScriptInputBackend::armTimer() noexcept {
+  if (m_next < m_transitions.size()) {
+    const int64_t deadline{m_start + m_transitions[m_next].time};
+    struct itimerspec spec{};
+    spec.it_value.tv_sec = static_cast<time_t>(deadline / (1000 * 1000));
+    spec.it_value.tv_nsec = static_cast<long>((deadline % (1000 * 1000)) * 1000);
+    ::timerfd_settime(m_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+  }
+}
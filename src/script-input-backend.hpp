@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCRIPT_INPUT_BACKEND_HPP
+#define SCRIPT_INPUT_BACKEND_HPP
+
+#include "input-backend.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * This class replays key transitions from a script instead of reading a
+ * device, so that the actuation pipeline can be driven without a human.
+ * Every line of the script is "<time in s> <key> <press|release>", e.g.
+ * "0.25 up press"; keys are named like in --bindings. The whole script is
+ * parsed into an array up front. In real time, a timerfd wakes the input
+ * thread at every transition; otherwise, the backend stays readable and
+ * every wakeup replays the next transition. After the last transition, the
+ * backend stays valid but idle like a device that nobody touches.
+ */
+class ScriptInputBackend : public InputBackend {
+ private:
+  ScriptInputBackend(const ScriptInputBackend &) = delete;
+  ScriptInputBackend(ScriptInputBackend &&) = delete;
+  ScriptInputBackend &operator=(const ScriptInputBackend &) = delete;
+  ScriptInputBackend &operator=(ScriptInputBackend &&) = delete;
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param file Script to replay.
+   * @param isRealtime If true, transitions are replayed at their times; otherwise, as fast as possible.
+   * @param delegate Function to call for every key transition.
+   */
+  ScriptInputBackend(const std::string &file, bool isRealtime, KeyDelegate delegate) noexcept;
+  ~ScriptInputBackend() noexcept override;
+
+  bool isValid() const noexcept override;
+  int32_t fileDescriptor() const noexcept override;
+
+  bool readEvents() noexcept override;
+  bool probe() noexcept override;
+
+  /**
+   * @return True once the last transition was replayed.
+   */
+  bool isFinished() const noexcept;
+
+ private:
+  bool load(const std::string &file) noexcept;
+  void armTimer() noexcept;
+
+ private:
+  struct Transition {
+    int64_t time; // Microseconds since the start of the replay.
+    uint16_t code;
+    bool pressed;
+  };
+
+  KeyDelegate m_delegate{nullptr};
+  bool m_isRealtime;
+  int32_t m_fd{-1};
+  std::vector<Transition> m_transitions{};
+  size_t m_next{0};
+  int64_t m_start{0};
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHARED_ACTUATION_REQUEST_HPP
+#define SHARED_ACTUATION_REQUEST_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * The latest ActuationRequest of one vehicle as published to shared memory.
+ */
+struct ActuationSample {
+  // Number of ActuationRequests published so far; set by SharedActuationRequest::write.
+  uint64_t sequenceNumber{0};
+  // CLOCK_MONOTONIC time in nanoseconds when the ActuationRequest was sent.
+  int64_t timeStamp{0};
+  float acceleration{0.0f};
+  float steering{0.0f};
+  uint32_t senderStamp{0};
+  uint16_t cid{0};
+  bool isValid{false};
+};
+
+/**
+ * One slot of the --shm segment; the segment holds one slot per vehicle in
+ * the order of --vehicles. The single writer never waits; readers in other
+ * processes retry while a write is in progress (sequence lock), so neither
+ * side needs the segment's mutex, a socket, or decoding. The writer never
+ * notifies the segment's condition either; consumers poll sequenceNumber to
+ * detect new samples:
+ *
+ *   cluon::SharedMemory shm{"gamepad"};
+ *   const auto *slots = reinterpret_cast<const SharedActuationRequest *>(shm.data());
+ *   ActuationSample sample = slots[0].read();
+ */
+class SharedActuationRequest {
+ private:
+  SharedActuationRequest(const SharedActuationRequest &) = delete;
+  SharedActuationRequest(SharedActuationRequest &&) = delete;
+  SharedActuationRequest &operator=(const SharedActuationRequest &) = delete;
+  SharedActuationRequest &operator=(SharedActuationRequest &&) = delete;
+
+ public:
+  SharedActuationRequest() = default;
+
+  /**
+   * This method publishes a new sample; only to be called by the writer.
+   *
+   * @param sample Sample to publish.
+   */
+  void write(const ActuationSample &sample) noexcept {
+    // An odd version marks a write in progress.
+    const uint64_t version{m_version.load(std::memory_order_relaxed)};
+    m_version.store(version + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_sample = sample;
+    m_sample.sequenceNumber = version / 2 + 1;
+    m_version.store(version + 2, std::memory_order_release);
+  }
+
+  /**
+   * This method fetches the latest sample without blocking the writer.
+   *
+   * @return Latest sample; its sequenceNumber is 0 if none was published yet.
+   */
+  ActuationSample read() const noexcept {
+    ActuationSample retVal;
+    uint64_t version{0};
+    do {
+      version = m_version.load(std::memory_order_acquire);
+      retVal = m_sample;
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((0 != (version & 1)) || (version != m_version.load(std::memory_order_relaxed)));
+    return retVal;
+  }
+
+ private:
+  std::atomic<uint64_t> m_version{0};
+  ActuationSample m_sample{};
+};
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Wait-free handoff of the latest value from exactly one writer thread to
+ * exactly one reader thread. The writer and the reader each own one of
+ * three slots and swap it with the third one in a single atomic exchange,
+ * so neither of them ever waits for the other one.
+ */
+template <typename T>
+class TripleBuffer {
+ private:
+  TripleBuffer(const TripleBuffer &) = delete;
+  TripleBuffer(TripleBuffer &&) = delete;
+  TripleBuffer &operator=(const TripleBuffer &) = delete;
+  TripleBuffer &operator=(TripleBuffer &&) = delete;
+
+ public:
+  TripleBuffer() = default;
+
+  /**
+   * This method publishes a new value; only to be called by the writer.
+   *
+   * @param value Value to publish.
+   */
+  void write(const T &value) noexcept {
+    m_slots[m_back] = value;
+    const uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_back | FRESH), std::memory_order_acq_rel);
+    m_back = previous & INDEX;
+  }
+
+  /**
+   * This method fetches the latest published value; only to be called by the reader.
+   *
+   * @param value Updated to the latest value if a new one was published.
+   * @return true if a new value was published since the last call.
+   */
+  bool read(T &value) noexcept {
+    bool retVal{false};
+    if (0 != (m_middle.load(std::memory_order_relaxed) & FRESH)) {
+      const uint8_t previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+      m_front = previous & INDEX;
+      retVal = true;
+    }
+    value = m_slots[m_front];
+    return retVal;
+  }
+
+ private:
+  static constexpr uint8_t INDEX{0x3};
+  static constexpr uint8_t FRESH{0x4};
+
+  T m_slots[3]{};
+  // Writer, reader, and the shared index live on separate cache lines.
+  alignas(64) uint8_t m_back{0};
+  alignas(64) std::atomic<uint8_t> m_middle{1};
+  alignas(64) uint8_t m_front{2};
+};
+
+#endif
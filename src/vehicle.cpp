@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "vehicle.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+Vehicle::Vehicle(const VehicleConfig &cfg, uint32_t devices, Arbitration arbitration,
+                 const std::vector<uint16_t> &overrideKeys, int32_t minAxesValue, int32_t maxAxesValue)
+    : config(cfg)
+    , keyBindings(cfg.bindings, cfg.limits)
+    , steeringAxis(minAxesValue, maxAxesValue, cfg.limits.steeringMax, 0.0f, 0.0f, cfg.limits.steeringMin)
+    , accelerationAxis(minAxesValue, maxAxesValue, cfg.limits.accelerationMax, cfg.limits.accelerationMin, cfg.limits.decelerationMin, cfg.limits.decelerationMax)
+    , inputArbiter(devices, arbitration, keyBindings, overrideKeys)
+    , controlShaper(cfg.accelerationShaping, cfg.steeringShaping) {}
+
+VehicleConfig Vehicle::configFromArguments(std::map<std::string, std::string> &arguments) {
+  VehicleConfig retVal;
+  retVal.cid = static_cast<uint16_t>(std::stoi(arguments["cid"]));
+  retVal.senderStamp = (arguments.count("sender_stamp") != 0) ? static_cast<uint32_t>(std::stoul(arguments["sender_stamp"])) : 0;
+  retVal.limits.accelerationMin = std::stof(arguments["acc_min"]);
+  retVal.limits.accelerationMax = std::stof(arguments["acc_max"]);
+  retVal.limits.decelerationMin = std::stof(arguments["dec_min"]);
+  retVal.limits.decelerationMax = std::stof(arguments["dec_max"]);
+  retVal.limits.steeringMin = std::stof(arguments["steering_min"]);
+  retVal.limits.steeringMax = std::stof(arguments["steering_max"]);
+
+  const ActuationLimits &l{retVal.limits};
+  retVal.accelerationShaping = ControlShaper::fromCommandline(arguments, "acc",
+      std::min({l.accelerationMin, l.accelerationMax, l.decelerationMin, l.decelerationMax}),
+      std::max({l.accelerationMin, l.accelerationMax, l.decelerationMin, l.decelerationMax}));
+  retVal.steeringShaping = ControlShaper::fromCommandline(arguments, "steering", l.steeringMin, l.steeringMax);
+  retVal.bindings = (arguments.count("bindings") != 0) ? arguments["bindings"] : KeyBindings::DEFAULT;
+  return retVal;
+}
+
+std::vector<std::map<std::string, std::string>> Vehicle::argumentsFromFile(const std::string &file,
+                                                                           const std::map<std::string, std::string> &defaults) {
+  std::vector<std::map<std::string, std::string>> retVal;
+  std::ifstream in(file);
+  std::string line;
+  while (std::getline(in, line)) {
+    std::stringstream sstr(line);
+    std::string token;
+    if (!(sstr >> token) || ('#' == token[0])) {
+      continue;
+    }
+    std::map<std::string, std::string> arguments{defaults};
+    do {
+      // Arguments look like on the command line: --key=value or --flag.
+      const size_t start{token.find_first_not_of('-')};
+      const size_t equals{token.find('=')};
+      if ((std::string::npos != start) && (start < equals)) {
+        arguments[token.substr(start, equals - start)] = (std::string::npos != equals) ? token.substr(equals + 1) : "1";
+      }
+    } while (sstr >> token);
+    retVal.push_back(arguments);
+  }
+  return retVal;
+}
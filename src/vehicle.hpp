@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VEHICLE_HPP
+#define VEHICLE_HPP
+
+#include "cluon-complete.hpp"
+#include "actuationrequestmessage.hpp"
+#include "actuation-state.hpp"
+#include "axis-table.hpp"
+#include "control-shaper.hpp"
+#include "input-arbiter.hpp"
+#include "key-bindings.hpp"
+#include "shared-actuation-request.hpp"
+#include "triple-buffer.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Configuration of one vehicle driven by this process.
+ */
+struct VehicleConfig {
+  uint16_t cid{0};
+  uint32_t senderStamp{0};
+  ActuationLimits limits{};
+  ShapingConfig accelerationShaping{};
+  ShapingConfig steeringShaping{};
+  std::string bindings{};
+};
+
+/**
+ * Everything that exists once per vehicle. The input thread feeds the
+ * vehicle's arbiter and publishes through actuationState; the sender shapes
+ * and sends the vehicle's ActuationRequests. Input devices, scheduler, and
+ * sockets are shared by all vehicles of the process.
+ */
+struct Vehicle {
+ private:
+  Vehicle(const Vehicle &) = delete;
+  Vehicle(Vehicle &&) = delete;
+  Vehicle &operator=(const Vehicle &) = delete;
+  Vehicle &operator=(Vehicle &&) = delete;
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param config Configuration of the vehicle.
+   * @param devices Number of input devices.
+   * @param arbitration Policy to select among active devices.
+   * @param overrideKeys Linux input event codes of the override keys.
+   * @param minAxesValue Raw axis position at the negative end.
+   * @param maxAxesValue Raw axis position at the positive end.
+   */
+  Vehicle(const VehicleConfig &config, uint32_t devices, Arbitration arbitration,
+          const std::vector<uint16_t> &overrideKeys, int32_t minAxesValue, int32_t maxAxesValue);
+  ~Vehicle() = default;
+
+  /**
+   * This method reads a vehicle's configuration from command line arguments
+   * (cid, sender_stamp, *_min/max limits, shaping, and bindings).
+   *
+   * @param arguments Parsed arguments.
+   * @return Configuration; throws std::exception for malformed numbers.
+   */
+  static VehicleConfig configFromArguments(std::map<std::string, std::string> &arguments);
+
+  /**
+   * This method reads one line of arguments per vehicle from a file; empty
+   * lines and lines starting with # are skipped. Every line is merged over
+   * the given defaults, e.g. "--cid=112 --sender_stamp=1 --acc_max=20".
+   *
+   * @param file File to read.
+   * @param defaults Arguments from the command line.
+   * @return Arguments per vehicle; empty if the file cannot be read.
+   */
+  static std::vector<std::map<std::string, std::string>> argumentsFromFile(const std::string &file,
+                                                                           const std::map<std::string, std::string> &defaults);
+
+ public:
+  const VehicleConfig config;
+  const KeyBindings keyBindings;
+  const AxisTable steeringAxis;
+  const AxisTable accelerationAxis;
+  InputArbiter inputArbiter;
+
+  // Owned by the input thread.
+  ActuationState inputState{};
+  bool hasInputChanged{false};
+
+  // Handover to the sender.
+  TripleBuffer<ActuationState> actuationState{};
+
+  // Owned by the sender.
+  ActuationState latestState{};
+  ControlShaper controlShaper;
+  opendlv::proxy::ActuationRequest ar{};
+  int64_t lastSendTime{0};
+  int64_t lastInputTimeStamp{0};
+  // Socket for the vehicle's CID; shared by all vehicles on that CID.
+  cluon::UDPSender *sender{nullptr};
+  // Slot in the --shm segment, if any.
+  SharedActuationRequest *sharedActuationRequest{nullptr};
+};
+
+#endif
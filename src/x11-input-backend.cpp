@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "x11-input-backend.hpp"
+#include "monotonic-time.hpp"
+
+#include <X11/XKBlib.h>
+#include <X11/keysym.h>
+#include <linux/input.h>
+
+#include <iostream>
+
+namespace {
+const char *windowName = "Gainput basic sample";
+const int width = 800;
+const int height = 600;
+
+struct KeyTranslation {
+  uint16_t code;
+  KeySym keySym;
+};
+
+// Translation from Linux input event codes to the X key symbols of a US layout.
+const KeyTranslation keyTranslations[] = {
+  {KEY_ESC, XK_Escape}, {KEY_SPACE, XK_space}, {KEY_ENTER, XK_Return},
+  {KEY_BACKSPACE, XK_BackSpace}, {KEY_TAB, XK_Tab},
+  {KEY_UP, XK_Up}, {KEY_DOWN, XK_Down}, {KEY_LEFT, XK_Left}, {KEY_RIGHT, XK_Right},
+  {KEY_LEFTSHIFT, XK_Shift_L}, {KEY_RIGHTSHIFT, XK_Shift_R},
+  {KEY_LEFTCTRL, XK_Control_L}, {KEY_RIGHTCTRL, XK_Control_R},
+  {KEY_LEFTALT, XK_Alt_L}, {KEY_RIGHTALT, XK_Alt_R},
+  {KEY_A, XK_a}, {KEY_B, XK_b}, {KEY_C, XK_c}, {KEY_D, XK_d},
+  {KEY_E, XK_e}, {KEY_F, XK_f}, {KEY_G, XK_g}, {KEY_H, XK_h},
+  {KEY_I, XK_i}, {KEY_J, XK_j}, {KEY_K, XK_k}, {KEY_L, XK_l},
+  {KEY_M, XK_m}, {KEY_N, XK_n}, {KEY_O, XK_o}, {KEY_P, XK_p},
+  {KEY_Q, XK_q}, {KEY_R, XK_r}, {KEY_S, XK_s}, {KEY_T, XK_t},
+  {KEY_U, XK_u}, {KEY_V, XK_v}, {KEY_W, XK_w}, {KEY_X, XK_x},
+  {KEY_Y, XK_y}, {KEY_Z, XK_z},
+  {KEY_0, XK_0}, {KEY_1, XK_1}, {KEY_2, XK_2}, {KEY_3, XK_3},
+  {KEY_4, XK_4}, {KEY_5, XK_5}, {KEY_6, XK_6}, {KEY_7, XK_7},
+  {KEY_8, XK_8}, {KEY_9, XK_9},
+};
+}
+
+X11InputBackend::X11InputBackend(const std::vector<uint16_t> &keys, bool inputOnly, KeyDelegate delegate) noexcept
+    : m_delegate(std::move(delegate)) {
+  m_display = XOpenDisplay(0);
+  if (nullptr == m_display) {
+    return;
+  }
+
+  // Held keys then repeat as KeyPress only instead of KeyRelease/KeyPress pairs.
+  Bool isSupported{False};
+  m_detectableAutoRepeat = (True == XkbSetDetectableAutoRepeat(m_display, True, &isSupported)) && (True == isSupported);
+
+  // Key events are all we need; thus, no GL context is created for the window.
+  Window root = DefaultRootWindow(m_display);
+  XSetWindowAttributes swa;
+  swa.event_mask = KeyPressMask | KeyReleaseMask | FocusChangeMask;
+  if (inputOnly) {
+    // An unmanaged 1x1 InputOnly window that takes the focus itself.
+    swa.event_mask |= StructureNotifyMask;
+    swa.override_redirect = True;
+    m_window = XCreateWindow(
+        m_display, root,
+        0, 0, 1, 1, 0,
+        0, InputOnly,
+        CopyFromParent, CWEventMask | CWOverrideRedirect,
+        &swa
+    );
+    XMapRaised(m_display, m_window);
+
+    // The focus can only be set once the window is viewable.
+    XEvent event;
+    do {
+      XWindowEvent(m_display, m_window, StructureNotifyMask, &event);
+    } while (MapNotify != event.type);
+    XSetInputFocus(m_display, m_window, RevertToParent, CurrentTime);
+  } else {
+    swa.event_mask |= ExposureMask | PointerMotionMask | ButtonPressMask | ButtonReleaseMask;
+    m_window = XCreateWindow(
+        m_display, root,
+        0, 0, width, height, 0,
+        CopyFromParent, InputOutput,
+        CopyFromParent, CWEventMask,
+        &swa
+    );
+
+    XSetWindowAttributes xattr;
+    xattr.override_redirect = False;
+    XChangeWindowAttributes(m_display, m_window, CWOverrideRedirect, &xattr);
+
+    XMapWindow(m_display, m_window);
+    XStoreName(m_display, m_window, windowName);
+  }
+
+  // The X keycodes of the wanted keys' symbols in the server's keymap.
+  for (uint16_t code : keys) {
+    for (const auto &t : keyTranslations) {
+      if (t.code == code) {
+        const KeyCode keycode{XKeysymToKeycode(m_display, t.keySym)};
+        if (0 != keycode) {
+          m_codes[keycode] = code;
+        }
+        break;
+      }
+    }
+  }
+}
+
+X11InputBackend::~X11InputBackend() noexcept {
+  if (nullptr != m_display) {
+    XDestroyWindow(m_display, m_window);
+    XCloseDisplay(m_display);
+  }
+}
+
+bool X11InputBackend::isValid() const noexcept {
+  return (nullptr != m_display);
+}
+
+int32_t X11InputBackend::fileDescriptor() const noexcept {
+  return isValid() ? ConnectionNumber(m_display) : -1;
+}
+
+bool X11InputBackend::readEvents() noexcept {
+  const int64_t now{monotonic::nowInMicroseconds()};
+  XEvent event;
+  // Every transition is reported in order with the time the X server saw it.
+  while (XPending(m_display)) {
+    XNextEvent(m_display, &event);
+    if (KeyPress == event.type) {
+      if (m_pressed.test(event.xkey.keycode)) {
+        continue; // Autorepeat.
+      }
+      m_pressed.set(event.xkey.keycode);
+      if (KEY_RESERVED != m_codes[event.xkey.keycode]) {
+        m_delegate(m_codes[event.xkey.keycode], true, monotonic::fromXServerTime(event.xkey.time, now));
+      }
+    } else if (KeyRelease == event.type) {
+      if (!m_detectableAutoRepeat && isAutoRepeat(event)) {
+        // Drop the synthetic release and the repeated press that follows it.
+        XNextEvent(m_display, &event);
+        continue;
+      }
+      if (m_pressed.test(event.xkey.keycode)) {
+        m_pressed.reset(event.xkey.keycode);
+        if (KEY_RESERVED != m_codes[event.xkey.keycode]) {
+          m_delegate(m_codes[event.xkey.keycode], false, monotonic::fromXServerTime(event.xkey.time, now));
+        }
+      }
+    } else if ((FocusOut == event.type) && m_pressed.any()) {
+      // Keys released while another window has the focus are never reported; thus, release all now.
+      for (uint32_t keycode{0}; keycode < m_pressed.size(); keycode++) {
+        if (m_pressed.test(keycode) && (KEY_RESERVED != m_codes[keycode])) {
+          m_delegate(m_codes[keycode], false, now);
+        }
+      }
+      m_pressed.reset();
+    }
+  }
+  return true;
+}
+
+bool X11InputBackend::probe() noexcept {
+  // Blocks until the X server answered.
+  XSync(m_display, False);
+  return true;
+}
+
+bool X11InputBackend::isAutoRepeat(const XEvent &release) noexcept {
+  // Without detectable autorepeat, a repeat is a release directly followed by
+  // a press of the same key with the same server time.
+  if (0 < XEventsQueued(m_display, QueuedAfterReading)) {
+    XEvent next;
+    XPeekEvent(m_display, &next);
+    return (KeyPress == next.type) && (next.xkey.keycode == release.xkey.keycode) && (next.xkey.time == release.xkey.time);
+  }
+  return false;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef X11_INPUT_BACKEND_HPP
+#define X11_INPUT_BACKEND_HPP
+
+#include "input-backend.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+#include <X11/Xlib.h>
+
+/**
+ * This class opens a window on the X server and reports every KeyPress and
+ * KeyRelease of the keys passed to the constructor at its server time. Key
+ * repeats of held keys are dropped, and all held keys are released when the
+ * window loses the focus.
+ */
+class X11InputBackend : public InputBackend {
+ private:
+  X11InputBackend(const X11InputBackend &) = delete;
+  X11InputBackend(X11InputBackend &&) = delete;
+  X11InputBackend &operator=(const X11InputBackend &) = delete;
+  X11InputBackend &operator=(X11InputBackend &&) = delete;
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param keys Linux input event codes of the keys to report.
+   * @param inputOnly If true, a 1x1 InputOnly window grabs the focus instead of showing a regular window.
+   * @param delegate Function to call for every transition of these keys.
+   */
+  X11InputBackend(const std::vector<uint16_t> &keys, bool inputOnly, KeyDelegate delegate) noexcept;
+  ~X11InputBackend() noexcept override;
+
+  bool isValid() const noexcept override;
+  int32_t fileDescriptor() const noexcept override;
+  bool readEvents() noexcept override;
+  bool probe() noexcept override;
+
+ private:
+  bool isAutoRepeat(const XEvent &release) noexcept;
+
+ private:
+  KeyDelegate m_delegate{nullptr};
+
+  Display *m_display{nullptr};
+  Window m_window{0};
+  bool m_detectableAutoRepeat{false};
+  // Linux input event code per X keycode; KEY_RESERVED for keys not reported.
+  std::array<uint16_t, 256> m_codes{};
+  // Pressed state per X keycode.
+  std::bitset<256> m_pressed{};
+};
+
+#endif
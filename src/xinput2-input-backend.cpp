@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "xinput2-input-backend.hpp"
+#include "monotonic-time.hpp"
+
+#include <X11/extensions/XInput2.h>
+
+#include <iostream>
+
+namespace {
+// X keycodes of the evdev driver are the Linux input event codes plus 8.
+const uint32_t KEYCODE_OFFSET{8};
+}
+
+XInput2InputBackend::XInput2InputBackend(const std::vector<uint16_t> &keys, KeyDelegate delegate) noexcept
+    : m_delegate(std::move(delegate)) {
+  for (uint16_t code : keys) {
+    if (code < KEY_CNT) {
+      m_watched.set(code);
+    }
+  }
+
+  m_display = XOpenDisplay(0);
+  if (nullptr == m_display) {
+    return;
+  }
+
+  int32_t event{0};
+  int32_t error{0};
+  int32_t major{2};
+  int32_t minor{2};
+  if ((False == XQueryExtension(m_display, "XInputExtension", &m_opcode, &event, &error)) ||
+      (Success != XIQueryVersion(m_display, &major, &minor))) {
+    std::cerr << "[XInput2InputBackend]: X server does not support XInput 2.2." << std::endl;
+    XCloseDisplay(m_display);
+    m_display = nullptr;
+    return;
+  }
+
+  unsigned char mask[XIMaskLen(XI_LASTEVENT)]{};
+  XISetMask(mask, XI_RawKeyPress);
+  XISetMask(mask, XI_RawKeyRelease);
+  XIEventMask eventMask{XIAllMasterDevices, static_cast<int>(sizeof(mask)), mask};
+  XISelectEvents(m_display, DefaultRootWindow(m_display), &eventMask, 1);
+  XFlush(m_display);
+}
+
+XInput2InputBackend::~XInput2InputBackend() noexcept {
+  if (nullptr != m_display) {
+    XCloseDisplay(m_display);
+  }
+}
+
+bool XInput2InputBackend::isValid() const noexcept {
+  return (nullptr != m_display);
+}
+
+int32_t XInput2InputBackend::fileDescriptor() const noexcept {
+  return isValid() ? ConnectionNumber(m_display) : -1;
+}
+
+bool XInput2InputBackend::readEvents() noexcept {
+  const int64_t now{monotonic::nowInMicroseconds()};
+  XEvent event;
+  // Drain everything that arrived with this wakeup.
+  while (XPending(m_display)) {
+    XNextEvent(m_display, &event);
+    XGenericEventCookie *cookie = &event.xcookie;
+    if ((GenericEvent != cookie->type) || (m_opcode != cookie->extension) ||
+        ((XI_RawKeyPress != cookie->evtype) && (XI_RawKeyRelease != cookie->evtype)) ||
+        (False == XGetEventData(m_display, cookie))) {
+      continue;
+    }
+
+    const XIRawEvent *raw = static_cast<const XIRawEvent *>(cookie->data);
+    const bool pressed{XI_RawKeyPress == cookie->evtype};
+    const uint32_t keycode{static_cast<uint32_t>(raw->detail)};
+    if ((KEYCODE_OFFSET <= keycode) && (keycode - KEYCODE_OFFSET < KEY_CNT)) {
+      const uint16_t code{static_cast<uint16_t>(keycode - KEYCODE_OFFSET)};
+      // Raw events of held keys may repeat; only transitions are reported.
+      if (m_watched.test(code) && (pressed != m_pressed.test(code))) {
+        m_pressed.set(code, pressed);
+        m_delegate(code, pressed, monotonic::fromXServerTime(raw->time, now));
+      }
+    }
+    XFreeEventData(m_display, cookie);
+  }
+  return true;
+}
+
+bool XInput2InputBackend::probe() noexcept {
+  // Blocks until the X server answered.
+  XSync(m_display, False);
+  return true;
+}
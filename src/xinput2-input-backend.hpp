@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2018  Christian Berger
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef XINPUT2_INPUT_BACKEND_HPP
+#define XINPUT2_INPUT_BACKEND_HPP
+
+#include "input-backend.hpp"
+
+#include <linux/input.h>
+
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+#include <X11/Xlib.h>
+
+/**
+ * This class selects XInput2 raw key events on the root window. Raw events
+ * are delivered regardless of which window has the focus, so the operator
+ * can type elsewhere without losing a key release. It needs no window; X keycodes are mapped to Linux input event codes (offset 8).
+ */
+class XInput2InputBackend : public InputBackend {
+ private:
+  XInput2InputBackend(const XInput2InputBackend &) = delete;
+  XInput2InputBackend(XInput2InputBackend &&) = delete;
+  XInput2InputBackend &operator=(const XInput2InputBackend &) = delete;
+  XInput2InputBackend &operator=(XInput2InputBackend &&) = delete;
+
+ public:
+  /**
+   * Constructor.
+   *
+   * @param keys Linux input event codes of the keys to report.
+   * @param delegate Function to call for every transition of these keys.
+   */
+  XInput2InputBackend(const std::vector<uint16_t> &keys, KeyDelegate delegate) noexcept;
+  ~XInput2InputBackend() noexcept override;
+
+  bool isValid() const noexcept override;
+  int32_t fileDescriptor() const noexcept override;
+  bool readEvents() noexcept override;
+  bool probe() noexcept override;
+
+ private:
+  KeyDelegate m_delegate{nullptr};
+  Display *m_display{nullptr};
+  int32_t m_opcode{-1};
+  std::bitset<KEY_CNT> m_watched{};
+  std::bitset<KEY_CNT> m_pressed{};
+};
+
+#endif